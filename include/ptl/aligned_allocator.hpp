@@ -1,5 +1,8 @@
 #pragma once
+#include <cassert>
+#include <cstddef>
 #include <cstdint>
+#include <cstdlib>
 #include <new>
 #include <type_traits>
 
@@ -14,7 +17,7 @@ struct Alignment
 };
 
 namespace detail {
-    void* allocate_aligned_memory(size_t align, size_t size)
+    inline void* allocate_aligned_memory(size_t align, size_t size)
     {
         assert(align >= sizeof(void*));
         
@@ -28,7 +31,7 @@ namespace detail {
         }
         return ptr;
     }
-    void deallocate_aligned_memory(void* ptr) noexcept
+    inline void deallocate_aligned_memory(void* ptr) noexcept
     {
         free(ptr);
     }
@@ -43,11 +46,17 @@ public:
     using difference_type = ptrdiff_t;
 
     using propagate_on_container_move_assignment = std::true_type;
+    using is_always_equal = std::true_type;
+
+    template<typename U>
+    struct rebind {
+        using other = aligned_allocator<U, A>;
+    };
 
     constexpr aligned_allocator() noexcept {}
     constexpr aligned_allocator(const aligned_allocator& other) noexcept {}
     template<typename U>
-    constexpr aligned_allocator(const aligned_allocator<U>& other) noexcept {}
+    constexpr aligned_allocator(const aligned_allocator<U, A>& other) noexcept {}
 
     /*constexpr*/ ~aligned_allocator() {}
 
@@ -64,6 +73,17 @@ public:
     {
         detail::deallocate_aligned_memory(p);
     }
+
+    template<typename U>
+    constexpr bool operator==(const aligned_allocator<U, A>&) const noexcept
+    {
+        return true;
+    }
+    template<typename U>
+    constexpr bool operator!=(const aligned_allocator<U, A>&) const noexcept
+    {
+        return false;
+    }
 };
 
 }
\ No newline at end of file
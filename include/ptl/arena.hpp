@@ -0,0 +1,192 @@
+#pragma once
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "ptl/aligned_allocator.hpp"
+
+namespace ptl {
+
+/* Bump allocator for objects sharing a lifetime, e.g. everything a request creates.  Allocation
+ * moves a cursor, deallocation does nothing, reset() takes everything back at once:
+ *
+ *   ptl::monotonic_arena arena;
+ *   for (;;) {
+ *       std::vector<header, ptl::arena_allocator<header>> headers(arena);
+ *       auto req = arena.make<request>(...);
+ *       ...
+ *       arena.reset();                      // no destructor runs
+ *   }
+ *
+ * The arena starts in an optional caller buffer, then in blocks from the heap that double in size.
+ * reset() keeps the newest block, the largest, so a steady load stops allocating after the first
+ * rounds.  Not thread safe: one arena per thread or per request.
+ */
+class monotonic_arena
+{
+public:
+    static constexpr size_t default_block_size = 64 * 1024;
+    static constexpr size_t max_block_size = 1024 * 1024;
+
+    explicit monotonic_arena(size_t block_size = default_block_size) noexcept
+        : next_block_size_(block_size)
+    {}
+
+    // Starts in buffer, which must outlive the arena
+    monotonic_arena(void* buffer, size_t size, size_t block_size = default_block_size) noexcept
+        : cursor_(reinterpret_cast<uintptr_t>(buffer))
+        , end_(cursor_ + size)
+        , initial_(buffer)
+        , initial_size_(size)
+        , next_block_size_(block_size)
+    {}
+
+    ~monotonic_arena()
+    {
+        release(nullptr);
+    }
+
+    monotonic_arena(const monotonic_arena&) = delete;
+    monotonic_arena& operator=(const monotonic_arena&) = delete;
+
+    void* allocate(size_t size, size_t align = alignof(std::max_align_t))
+    {
+        assert(align != 0 && (align & (align - 1)) == 0);
+        auto p = (cursor_ + align - 1) & ~(align - 1);
+        if (p + size > end_ || p < cursor_) {
+            return allocate_slow(size, align);
+        }
+        cursor_ = p + size;
+        return reinterpret_cast<void*>(p);
+    }
+
+    void deallocate(void*, size_t, size_t = alignof(std::max_align_t)) noexcept
+    {}
+
+    // The object is never destroyed by the arena
+    template <typename T, typename... ARGS>
+    T* make(ARGS&&... args)
+    {
+        return new (allocate(sizeof(T), alignof(T))) T(std::forward<ARGS>(args)...);
+    }
+
+    // Everything allocated so far is gone
+    void reset() noexcept
+    {
+        release(blocks_);
+        if (blocks_ != nullptr) {
+            blocks_->prev = nullptr;
+            cursor_ = reinterpret_cast<uintptr_t>(blocks_) + sizeof(block);
+            end_ = reinterpret_cast<uintptr_t>(blocks_) + blocks_->size;
+        } else {
+            cursor_ = reinterpret_cast<uintptr_t>(initial_);
+            end_ = cursor_ + initial_size_;
+        }
+    }
+
+private:
+    struct alignas(Alignment::CACHE_LINE) block
+    {
+        block* prev;
+        size_t size;
+    };
+
+    void* allocate_slow(size_t size, size_t align)
+    {
+        auto needed = sizeof(block) + size + (align > alignof(block) ? align : 0);
+        auto block_size = std::max(next_block_size_, needed);
+        auto memory = detail::allocate_aligned_memory(alignof(block), block_size);
+        if (memory == nullptr) {
+            throw std::bad_alloc();
+        }
+        blocks_ = new (memory) block{ blocks_, block_size };
+        next_block_size_ = std::max(next_block_size_, std::min(next_block_size_ * 2, max_block_size));
+
+        cursor_ = reinterpret_cast<uintptr_t>(blocks_) + sizeof(block);
+        end_ = reinterpret_cast<uintptr_t>(blocks_) + block_size;
+        return allocate(size, align);
+    }
+
+    // Frees the blocks older than keep, all of them for nullptr
+    void release(block* keep) noexcept
+    {
+        auto b = keep != nullptr ? keep->prev : blocks_;
+        while (b != nullptr) {
+            auto prev = b->prev;
+            detail::deallocate_aligned_memory(b);
+            b = prev;
+        }
+        blocks_ = keep;
+    }
+
+    uintptr_t cursor_ = 0;
+    uintptr_t end_ = 0;
+    block* blocks_ = nullptr;
+    void* initial_ = nullptr;
+    size_t initial_size_ = 0;
+    size_t next_block_size_;
+};
+
+/* Standard allocator over a monotonic_arena, aligned to at least A like aligned_allocator.  Copies
+ * and rebinds share the arena, deallocate() does nothing.
+ */
+template <typename T, size_t A = alignof(T)>
+class arena_allocator
+{
+public:
+    using value_type = T;
+    using size_type = size_t;
+    using difference_type = ptrdiff_t;
+
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    template <typename U>
+    struct rebind {
+        using other = arena_allocator<U, A>;
+    };
+
+    arena_allocator(monotonic_arena& arena) noexcept
+        : arena_(&arena)
+    {}
+    template <typename U>
+    arena_allocator(const arena_allocator<U, A>& other) noexcept
+        : arena_(other.arena_)
+    {}
+
+    [[nodiscard]] T* allocate(size_type n)
+    {
+        constexpr size_type alignment = A > alignof(T) ? A : alignof(T);
+        return static_cast<T*>(arena_->allocate(n * sizeof(T), alignment));
+    }
+    void deallocate(T*, size_type) noexcept
+    {}
+
+    monotonic_arena& arena() const noexcept
+    {
+        return *arena_;
+    }
+
+    template <typename U>
+    bool operator==(const arena_allocator<U, A>& other) const noexcept
+    {
+        return arena_ == other.arena_;
+    }
+    template <typename U>
+    bool operator!=(const arena_allocator<U, A>& other) const noexcept
+    {
+        return arena_ != other.arena_;
+    }
+
+private:
+    template <typename U, size_t B>
+    friend class arena_allocator;
+
+    monotonic_arena* arena_;
+};
+
+}
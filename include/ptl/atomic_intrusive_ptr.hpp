@@ -0,0 +1,83 @@
+#pragma once
+#include <atomic>
+#include "ptl/epoch.hpp"
+#include "ptl/intrusive_ptr.hpp"
+
+namespace ptl {
+
+/* An intrusive_ptr slot readers can share with writers.  It holds one reference to the object it
+ * points to; a writer replacing the object retires that reference to the epoch domain instead of
+ * dropping it, so a reader holding an epoch guard can use the raw pointer without touching the
+ * count:
+ *
+ *   ptl::atomic_intrusive_ptr<config> current;
+ *
+ *   current.store(ptl::make_intrusive<config>(...));   // writer
+ *
+ *   ptl::epoch::guard g;                               // reader
+ *   auto c = current.load(g);
+ *
+ * load() without a guard takes a reference, for readers that keep the object beyond a guard.
+ */
+template<typename T>
+class atomic_intrusive_ptr
+{
+public:
+    constexpr atomic_intrusive_ptr() noexcept
+        : ptr_(nullptr)
+    {}
+
+    explicit atomic_intrusive_ptr(intrusive_ptr<T> desired) noexcept
+        : ptr_(desired.detach())
+    {}
+
+    // Nobody may use the object through the slot any more
+    ~atomic_intrusive_ptr()
+    {
+        intrusive_ptr<T>(ptr_.load(std::memory_order_relaxed));
+    }
+
+    atomic_intrusive_ptr(const atomic_intrusive_ptr&) = delete;
+    atomic_intrusive_ptr& operator=(const atomic_intrusive_ptr&) = delete;
+
+    // Valid as long as the guard lives
+    T* load(const epoch::guard&) const noexcept
+    {
+        return ptr_.load(std::memory_order_acquire);
+    }
+
+    intrusive_ptr<T> load() const
+    {
+        // the slot's reference cannot be dropped under the guard, the count is at least one
+        epoch::guard g;
+        return intrusive_ptr<T>(true, load(g));
+    }
+
+    void store(intrusive_ptr<T> desired)
+    {
+        retire(ptr_.exchange(desired.detach(), std::memory_order_acq_rel));
+    }
+
+    // On success the slot takes desired over, on failure expected is what the slot held
+    bool compare_exchange_strong(T*& expected, intrusive_ptr<T>& desired)
+    {
+        if (ptr_.compare_exchange_strong(expected, desired.get(), std::memory_order_acq_rel, std::memory_order_acquire)) {
+            desired.detach();
+            retire(expected);
+            return true;
+        }
+        return false;
+    }
+
+private:
+    static void retire(T* ptr)
+    {
+        if (ptr != nullptr) {
+            epoch::retire(ptr, [](void* p) noexcept { intrusive_ptr<T>(static_cast<T*>(p)); });
+        }
+    }
+
+    std::atomic<T*> ptr_;
+};
+
+} // namespace ptl
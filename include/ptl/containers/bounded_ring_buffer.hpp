@@ -1,90 +1,405 @@
 #pragma once
+#include <algorithm>
 #include <array>
+#include <atomic>
+#include <cstddef>
+#include <iterator>
+#include <new>
 #include <optional>
+#include <type_traits>
+#include <utility>
 
+#include <cassert>
 #include "ptl/synchronize.hpp"
-#include "ptl/scope_guard.hpp"
 
 namespace ptl {
 
+// LOCKING policy selecting the lock-free multi producer, single consumer ring
+struct mpsc_lockless {};
+// LOCKING policy selecting the lock-free single producer, single consumer ring
+struct spsc_lockless {};
+
+namespace detail {
+
+// Uninitialized storage for N elements, positions are masked into it
+template<typename T, size_t N>
+class ring_storage
+{
+    static_assert(N > 0 && (N & (N - 1)) == 0, "capacity must be a power of two");
+
+public:
+    static constexpr size_t mask = N - 1;
+
+    void* cell(size_t pos) noexcept
+    {
+        return &bytes_[(pos & mask) * sizeof(T)];
+    }
+    // an element constructed at pos
+    T* slot(size_t pos) noexcept
+    {
+        return std::launder(static_cast<T*>(cell(pos)));
+    }
+
+private:
+    alignas(T) std::byte bytes_[N * sizeof(T)];
+};
+
+} // namespace detail
+
+/* Fixed capacity FIFO guarded by a LOCKING policy, null_lock (the default) for a single thread or a
+ * mutex otherwise.  Elements live in uninitialized storage, constructed on push and destroyed on pop,
+ * so T needs no default constructor and a bounded_ring_buffer never allocates.
+ *
+ * exchange() makes a ring that keeps the latest N items, e.g. for telemetry: once full every push
+ * evicts and returns the oldest item.
+ */
 template<typename T, size_t N, typename LOCKING = null_lock>
 class bounded_ring_buffer
 {
+    static_assert(std::is_nothrow_destructible_v<T>);
+
 public:
-    constexpr bounded_ring_buffer() noexcept
+    bounded_ring_buffer() noexcept
         : head_(0)
         , tail_(0)
     {}
 
-    void push(T&& item) noexcept
+    ~bounded_ring_buffer()
+    {
+        while (head_ != tail_) {
+            storage_.slot(head_++)->~T();
+        }
+    }
+
+    bounded_ring_buffer(const bounded_ring_buffer&) = delete;
+    bounded_ring_buffer& operator=(const bounded_ring_buffer&) = delete;
+
+    static constexpr size_t capacity() noexcept
+    {
+        return N;
+    }
+
+    // The ring must not be full
+    void push(T&& item) noexcept(std::is_nothrow_move_constructible_v<T>)
     {
         synchronize(lock_, [&]() {
-            assert(free() > 0);
-            SCOPE_EXIT({ if (tail_ == total_size_) tail_ = 0; });
-            std::exchange(buffer_[tail_++], item);
+            assert(available() < N);
+            construct(std::move(item));
         });
     }
 
-    std::optional<T> pop() noexcept
+    // false when full
+    template <typename... ARGS>
+    bool try_emplace(ARGS&&... args) noexcept(std::is_nothrow_constructible_v<T, ARGS...>)
     {
-        synchronize(lock_, [&]() {
-            if (available() > 0) {
-                SCOPE_EXIT({ if (head_ == total_size_) head_ = 0; });
-                return std::exchange(buffer_[head_++], {});
+        return synchronize(lock_, [&]() {
+            if (available() == N) {
+                return false;
             }
-            return std::nullopt;
+            construct(std::forward<ARGS>(args)...);
+            return true;
         });
     }
 
-    std::optional<T> exchange(T&& item) noexcept
+    bool try_push(T&& item) noexcept(std::is_nothrow_move_constructible_v<T>)
     {
-        synchronize(lock_, [&]() {
-            if (available() > 0) {
-                if (head_ == tail_) {
-                    return std::move(item);
-                }
+        return try_emplace(std::move(item));
+    }
 
-                SCOPE_EXIT({
-                    if (head_ == total_size_) head_ = 0; 
-                    if (tail_ == total_size_) tail_ = 0;
-                });
-                std::exchange(buffer_[tail_++], item);
-                return std::exchange(buffer_[head_++], {});
-            } else {
-                SCOPE_EXIT({ if (tail_ == total_size_) tail_ = 0; });
-                std::exchange(buffer_[tail_++], item);
+    std::optional<T> pop() noexcept(std::is_nothrow_move_constructible_v<T>)
+    {
+        return synchronize(lock_, [&]() -> std::optional<T> {
+            if (available() == 0) {
+                return std::nullopt;
             }
-            return std::nullopt;
+            return take();
         });
     }
 
-    size_t count() noexcept 
+    // Pushes item, evicting and returning the oldest one when the ring is full
+    std::optional<T> exchange(T&& item) noexcept(std::is_nothrow_move_constructible_v<T>)
     {
-        synchronize(lock_, [&]() {
+        return synchronize(lock_, [&]() -> std::optional<T> {
+            if (available() < N) {
+                construct(std::move(item));
+                return std::nullopt;
+            }
+            auto oldest = take();
+            construct(std::move(item));
+            return oldest;
+        });
+    }
+
+    size_t count() noexcept
+    {
+        return synchronize(lock_, [&]() {
             return available();
         });
     }
 
 private:
-    size_t available() noexcept
+    size_t available() const noexcept
     {
-        if (tail_ < head_) {
-            return total_size_ + head_ - tail_;
-        }
         return tail_ - head_;
     }
-    size_t free() noexcept
+
+    template <typename... ARGS>
+    void construct(ARGS&&... args)
     {
-        return total_size_ - available();
+        new (storage_.cell(tail_)) T(std::forward<ARGS>(args)...);
+        ++tail_;
     }
 
-    static constexpr size_t total_size_ = N - 1;
-
+    std::optional<T> take()
+    {
+        auto item = storage_.slot(head_);
+        std::optional<T> result{ std::move(*item) };
+        item->~T();
+        ++head_;
+        return result;
+    }
 
     LOCKING lock_;
-    std::size_t head_;
-    std::size_t tail_;
-    std::array<T, N> buffer_;
+    // free running, masked into the storage
+    size_t head_;
+    size_t tail_;
+    detail::ring_storage<T, N> storage_;
+};
+
+/* Lock-free multi producer, single consumer ring.  Every cell carries a sequence number telling
+ * whose turn it is: producers claim a position with a CAS on tail_ and publish by bumping the
+ * sequence, the single consumer owns head_ and needs no read-modify-write at all.  head_ is still
+ * atomic so that count() may read it from any thread.
+ */
+template<typename T, size_t N>
+class bounded_ring_buffer<T, N, mpsc_lockless>
+{
+    static_assert(N > 0 && (N & (N - 1)) == 0, "capacity must be a power of two");
+    static_assert(std::is_nothrow_move_assignable_v<T>);
+
+public:
+    bounded_ring_buffer() noexcept
+        : head_(0)
+        , tail_(0)
+    {
+        for (size_t i = 0; i < N; i++) {
+            cells_[i].sequence_.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    bounded_ring_buffer(const bounded_ring_buffer&) = delete;
+    bounded_ring_buffer& operator=(const bounded_ring_buffer&) = delete;
+
+    // any thread, false when full
+    bool try_push(T item) noexcept
+    {
+        auto pos = tail_.load(std::memory_order_relaxed);
+        while (true) {
+            auto& cell = cells_[pos & mask_];
+            auto sequence = cell.sequence_.load(std::memory_order_acquire);
+            auto diff = static_cast<std::ptrdiff_t>(sequence - pos);
+            if (diff == 0) {
+                if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    cell.value_ = std::move(item);
+                    cell.sequence_.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = tail_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // consumer only, empty until the oldest claimed position is published
+    std::optional<T> pop() noexcept
+    {
+        auto head = head_.load(std::memory_order_relaxed);
+        auto& cell = cells_[head & mask_];
+        if (cell.sequence_.load(std::memory_order_acquire) != head + 1) {
+            return std::nullopt;
+        }
+        std::optional<T> item{ std::move(cell.value_) };
+        cell.sequence_.store(head + N, std::memory_order_release);
+        head_.store(head + 1, std::memory_order_release);
+        return item;
+    }
+
+    // exact on the consumer, a snapshot anywhere else
+    size_t count() const noexcept
+    {
+        // head first: it never passes tail, so the difference cannot wrap
+        auto head = head_.load(std::memory_order_acquire);
+        return tail_.load(std::memory_order_acquire) - head;
+    }
+
+private:
+    static constexpr size_t mask_ = N - 1;
+    static constexpr size_t cache_line_ = 64;
+
+    struct cell
+    {
+        std::atomic<size_t> sequence_;
+        T value_;
+    };
+
+    alignas(cache_line_) std::atomic<size_t> head_;
+    alignas(cache_line_) std::atomic<size_t> tail_;
+    alignas(cache_line_) std::array<cell, N> cells_;
+};
+
+
+/* Lock-free single producer, single consumer ring, e.g. an I/O thread handing work to one worker.
+ * Each side owns its index and keeps a cached copy of the other one, so it only reads the other
+ * side's cache line when the cached view says full (producer) or empty (consumer).  Indices grow
+ * freely and are masked into the storage; elements are constructed in place and need not be
+ * default-constructible.
+ *
+ *   ptl::bounded_ring_buffer<request, 1024, ptl::spsc_lockless> ring;
+ *
+ *   ring.try_emplace(fd, buffer);               // producer
+ *   while (auto r = ring.pop()) { ... }         // consumer
+ *
+ * push_n/pop_n move a batch with a single publication of the index.
+ */
+template<typename T, size_t N>
+class bounded_ring_buffer<T, N, spsc_lockless>
+{
+    static_assert(std::is_nothrow_destructible_v<T>);
+
+public:
+    bounded_ring_buffer() noexcept
+        : head_(0)
+        , cached_tail_(0)
+        , tail_(0)
+        , cached_head_(0)
+    {}
+
+    ~bounded_ring_buffer()
+    {
+        auto tail = tail_.load(std::memory_order_relaxed);
+        for (auto head = head_.load(std::memory_order_relaxed); head != tail; ++head) {
+            storage_.slot(head)->~T();
+        }
+    }
+
+    bounded_ring_buffer(const bounded_ring_buffer&) = delete;
+    bounded_ring_buffer& operator=(const bounded_ring_buffer&) = delete;
+
+    static constexpr size_t capacity() noexcept
+    {
+        return N;
+    }
+
+    // producer only, false when full; nothing is published if the constructor throws
+    template <typename... ARGS>
+    bool try_emplace(ARGS&&... args) noexcept(std::is_nothrow_constructible_v<T, ARGS...>)
+    {
+        auto tail = tail_.load(std::memory_order_relaxed);
+        if (tail - cached_head_ == N) {
+            cached_head_ = head_.load(std::memory_order_acquire);
+            if (tail - cached_head_ == N) {
+                return false;
+            }
+        }
+        new (storage_.cell(tail)) T(std::forward<ARGS>(args)...);
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool try_push(T&& item) noexcept(std::is_nothrow_move_constructible_v<T>)
+    {
+        return try_emplace(std::move(item));
+    }
+    bool try_push(const T& item) noexcept(std::is_nothrow_copy_constructible_v<T>)
+    {
+        return try_emplace(item);
+    }
+
+    // producer only, moves up to count items from first and returns how many were taken
+    template <typename IT>
+    size_t push_n(IT first, size_t count)
+    {
+        auto tail = tail_.load(std::memory_order_relaxed);
+        if (N - (tail - cached_head_) < count) {
+            cached_head_ = head_.load(std::memory_order_acquire);
+        }
+        count = std::min(count, N - (tail - cached_head_));
+
+        size_t pushed = 0;
+        try {
+            for (; pushed < count; ++pushed, ++first) {
+                new (storage_.cell(tail + pushed)) T(std::move(*first));
+            }
+        } catch (...) {
+            tail_.store(tail + pushed, std::memory_order_release);
+            throw;
+        }
+        tail_.store(tail + pushed, std::memory_order_release);
+        return pushed;
+    }
+
+    // consumer only
+    std::optional<T> pop() noexcept(std::is_nothrow_move_constructible_v<T>)
+    {
+        auto head = head_.load(std::memory_order_relaxed);
+        if (head == cached_tail_) {
+            cached_tail_ = tail_.load(std::memory_order_acquire);
+            if (head == cached_tail_) {
+                return std::nullopt;
+            }
+        }
+        auto item = storage_.slot(head);
+        std::optional<T> result{ std::move(*item) };
+        item->~T();
+        head_.store(head + 1, std::memory_order_release);
+        return result;
+    }
+
+    // consumer only, moves up to count items to out and returns how many were given
+    template <typename OUT>
+    size_t pop_n(OUT out, size_t count)
+    {
+        auto head = head_.load(std::memory_order_relaxed);
+        if (cached_tail_ - head < count) {
+            cached_tail_ = tail_.load(std::memory_order_acquire);
+        }
+        count = std::min(count, cached_tail_ - head);
+
+        size_t popped = 0;
+        try {
+            for (; popped < count; ++popped) {
+                auto item = storage_.slot(head + popped);
+                *out = std::move(*item);
+                ++out;
+                item->~T();
+            }
+        } catch (...) {
+            head_.store(head + popped, std::memory_order_release);
+            throw;
+        }
+        head_.store(head + popped, std::memory_order_release);
+        return popped;
+    }
+
+    // a snapshot, exact while the other side is idle
+    size_t count() const noexcept
+    {
+        auto head = head_.load(std::memory_order_acquire);
+        return tail_.load(std::memory_order_acquire) - head;
+    }
+
+private:
+    static constexpr size_t cache_line_ = 64;
+
+    // consumer
+    alignas(cache_line_) std::atomic<size_t> head_;
+    size_t cached_tail_;
+    // producer
+    alignas(cache_line_) std::atomic<size_t> tail_;
+    size_t cached_head_;
+    alignas(cache_line_) detail::ring_storage<T, N> storage_;
 };
 
-}
\ No newline at end of file
+}
@@ -1,7 +1,12 @@
 #pragma once
+#include <cassert>
+#include <cstddef>
 #include <cstdlib>
 #include <cstdint>
+#include <type_traits>
+#include <utility>
 #include "ptl/hash/fnv1a.hpp"
+#include "ptl/intrusive_ptr.hpp"
 
 namespace ptl {
 
@@ -23,24 +28,29 @@ struct IntrusiveSListBinding
 #define INTRUSIVE_SLIST_BINDING(type, field)                                                                                     \
     type, ptl::detail::IntrusiveSListBinding<ptl::fnv1a_32(MAKE_INTRUSIVE_SLIST_BINDING_STRING(type, field))>
 
+// The list holds a reference to every item it links, items have the intrusive_ptr API
+struct intrusive_slist_counted {};
+// The list only links items, their lifetime is managed elsewhere
+struct intrusive_slist_raw {};
+
 template <typename T, typename BIND>
 struct IntrusiveSListEntry
 {
     IntrusiveSListEntry()
-        : next_()
+        : next_(nullptr)
     {}
 
-    ~IntrusiveSListEntry()
-    {
-    }
+    IntrusiveSListEntry(const IntrusiveSListEntry&) = delete;
+    IntrusiveSListEntry& operator=(const IntrusiveSListEntry&) = delete;
 
-    intrusive_ptr<T> next()
+    // The item after this one, only meaningful while it is in a list
+    T* next() const noexcept
     {
-        return intrusive_ptr<T>(from_entry(next_), true);
+        return next_ ? next_->from_entry() : nullptr;
     }
 
 private:
-    template <typename Ty, typename B>
+    template <typename Ty, typename B, typename L>
     friend struct IntrusiveSList;
 
     T* from_entry() const noexcept
@@ -48,94 +58,158 @@ private:
         return reinterpret_cast<T *>(reinterpret_cast<uintptr_t>(this) - BIND::offset);
     }
 
-    intrusive_ptr<IntrusiveSListEntry<T, BIND>> next_;
-
-    friend intrusive_ptr<IntrusiveSListEntry>;
-    void intrusive_ptr_add_ref()
-    {
-        from_entry()->intrusive_ptr_add_ref();
-    }
-    void intrusive_ptr_release()
-    {
-        from_entry()->intrusive_ptr_release();
-    }
+    IntrusiveSListEntry* next_;
 };
 
-template <typename T, typename BIND>
+/* Singly linked intrusive list with a tail pointer: push_back, back, pop_front and splice are
+ * O(1).  Links are plain pointers whatever the LINK policy, so walking the list never touches a
+ * reference count: a counted list takes one reference when an item goes in and hands it over when
+ * the item comes out.
+ */
+template <typename T, typename BIND, typename LINK = intrusive_slist_counted>
 struct IntrusiveSList
 {
-    IntrusiveSList() = default;
-    ~IntrusiveSList() = default;
+    static constexpr bool counted = std::is_same_v<LINK, intrusive_slist_counted>;
+    using pointer = std::conditional_t<counted, intrusive_ptr<T>, T*>;
 
-    void push_back(intrusive_ptr<T> item)
-    {
-        auto entry = decltype(head_)(to_entry(item.get()), true);
+    IntrusiveSList() noexcept
+        : head_(nullptr)
+        , tail_(nullptr)
+    {}
 
-        auto *curr = &head_->next_;
-        while (*curr) {
-            curr = &((*curr)->next_);
+    IntrusiveSList(const IntrusiveSList&) = delete;
+    IntrusiveSList& operator=(const IntrusiveSList&) = delete;
+
+    IntrusiveSList(IntrusiveSList&& other) noexcept
+        : head_(std::exchange(other.head_, nullptr))
+        , tail_(std::exchange(other.tail_, nullptr))
+    {}
+
+    IntrusiveSList& operator=(IntrusiveSList&& other) noexcept
+    {
+        if (this != &other) {
+            clear();
+            head_ = std::exchange(other.head_, nullptr);
+            tail_ = std::exchange(other.tail_, nullptr);
         }
-        *curr = std::move(entry);
+        return *this;
     }
 
-    template<typename... Args>
-    void emplace_back(Args... args)
+    ~IntrusiveSList()
     {
-        auto entry = decltype(head_)(to_entry(new T(std::forward<Args>(args)...)));
+        clear();
+    }
 
-        auto *curr = &head_;
-        while (*curr) {
-            curr = &((*curr)->next_);
+    void push_back(pointer item)
+    {
+        auto entry = to_entry(adopt(std::move(item)));
+        if (tail_) {
+            tail_->next_ = entry;
+        } else {
+            head_ = entry;
         }
-        *curr = std::move(entry);
+        tail_ = entry;
+    }
+
+    template<typename... Args>
+    void emplace_back(Args&&... args)
+    {
+        static_assert(counted, "a raw list does not own its items");
+        push_back(pointer(new T(std::forward<Args>(args)...)));
     }
 
-    void push_front(intrusive_ptr<T> item)
+    void push_front(pointer item)
     {
-        auto entry = decltype(head_)(to_entry(item.get()), true);
-        std::exchange(entry->next_, std::exchange(head_, entry));
+        auto entry = to_entry(adopt(std::move(item)));
+        entry->next_ = head_;
+        head_ = entry;
+        if (!tail_) {
+            tail_ = entry;
+        }
     }
 
-    intrusive_ptr<T> front()
+    pointer pop_front()
     {
         if (!head_) {
-            return {};
+            return pointer();
+        }
+        auto entry = std::exchange(head_, head_->next_);
+        entry->next_ = nullptr;
+        if (!head_) {
+            tail_ = nullptr;
         }
-        auto entry = from_entry(head_.get());
-        return intrusive_ptr<T>(entry, true);
+        // a counted list hands its reference over
+        return pointer(entry->from_entry());
     }
 
-    intrusive_ptr<T> back()
+    // Moves all of other's items to the end of this list
+    void splice(IntrusiveSList& other) noexcept
     {
-        auto& last = head_;
-        if (head_) {
-            auto& curr = head_->next_;
-            while (curr) {
-                last = curr;
-                curr = curr->next_;
-            }
+        if (!other.head_) {
+            return;
         }
+        if (tail_) {
+            tail_->next_ = other.head_;
+        } else {
+            head_ = other.head_;
+        }
+        tail_ = other.tail_;
+        other.head_ = nullptr;
+        other.tail_ = nullptr;
+    }
 
-        auto entry = from_entry(last.get());
-        return intrusive_ptr<T>(true, entry);
+    pointer front() const
+    {
+        return share(head_);
     }
 
-    bool empty() const
+    pointer back() const
+    {
+        return share(tail_);
+    }
+
+    bool empty() const noexcept
     {
         return !head_;
     }
 
+    void clear()
+    {
+        while (head_) {
+            pop_front();
+        }
+    }
+
 private:
-    IntrusiveSListEntry<T, BIND> *to_entry(T *item) const noexcept
+    static T* adopt(pointer item) noexcept
     {
-        return reinterpret_cast<IntrusiveSListEntry<T, BIND> *>(reinterpret_cast<uintptr_t>(item) + BIND::offset);
+        assert(item);
+        if constexpr (counted) {
+            return item.detach();
+        } else {
+            return item;
+        }
     }
-    T *from_entry(IntrusiveSListEntry<T, BIND> *entry) const noexcept
+
+    static pointer share(IntrusiveSListEntry<T, BIND>* entry)
     {
-        return reinterpret_cast<T *>(reinterpret_cast<uintptr_t>(entry) - BIND::offset);
+        if (!entry) {
+            return pointer();
+        }
+        if constexpr (counted) {
+            return intrusive_ptr<T>(true, entry->from_entry());
+        } else {
+            return entry->from_entry();
+        }
+    }
+
+    static IntrusiveSListEntry<T, BIND> *to_entry(T *item) noexcept
+    {
+        return reinterpret_cast<IntrusiveSListEntry<T, BIND> *>(reinterpret_cast<uintptr_t>(item) + BIND::offset);
     }
 
-    intrusive_ptr<IntrusiveSListEntry<T, BIND>> head_;
+    IntrusiveSListEntry<T, BIND>* head_;
+    IntrusiveSListEntry<T, BIND>* tail_;
 };
 
-} // namespace ptl
\ No newline at end of file
+} // namespace ptl
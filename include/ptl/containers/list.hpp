@@ -1,6 +1,7 @@
 #pragma once
 #include <cstdlib>
 #include <cstdint>
+#include <memory>
 #include "ptl/hash/fnv1a.hpp"
 
 namespace ptl {
@@ -32,6 +33,10 @@ namespace ptl {
  * // These will automagically use the correct entry1/entry2 fields in my_data.
  * my_list1.list.push_back(new my_data { 3 });
  * my_list2.list.push_back(new my_data { 4 });
+ *
+ * A List deletes the items still linked when it is destroyed.  Its DISPOSER policy changes that:
+ * List<LIST_BINDING(my_data, entry1), list_unlink> only unlinks them, list_destroy runs their
+ * destructor without freeing, for items made in a monotonic_arena.
  */
 
 namespace detail {
@@ -52,6 +57,24 @@ struct ListBinding
 #define LIST_BINDING(type, field)                                                                                      \
     type, ptl::detail::ListBinding<ptl::fnv1a_32(MAKE_LIST_BINDING_STRING(type, field))>
 
+// DISPOSER for items owned elsewhere: they are only unlinked
+struct list_unlink
+{
+    template <typename T>
+    void operator()(T*) const noexcept
+    {}
+};
+
+// DISPOSER for items whose memory belongs to an allocator such as a monotonic_arena
+struct list_destroy
+{
+    template <typename T>
+    void operator()(T* item) const noexcept
+    {
+        item->~T();
+    }
+};
+
 template <typename T, typename BIND>
 struct ListEntry
 {
@@ -105,7 +128,7 @@ struct ListEntry
     }
 
 private:
-    template <typename Ty, typename B>
+    template <typename Ty, typename B, typename D>
     friend struct List;
 
     ListEntry<T, BIND> *to_entry(T *item) const noexcept
@@ -121,14 +144,16 @@ private:
     ListEntry<T, BIND> *prev_;
 };
 
-template <typename T, typename BIND>
+template <typename T, typename BIND, typename DISPOSER = std::default_delete<T>>
 struct List
 {
     List() = default;
     ~List()
     {
         while (!empty()) {
-            delete front();
+            auto item = front();
+            to_entry(item)->remove();
+            DISPOSER{}(item);
         }
     }
 
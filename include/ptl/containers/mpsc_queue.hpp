@@ -0,0 +1,127 @@
+#pragma once
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include "ptl/containers/slist.hpp"
+
+namespace ptl {
+
+/* Intrusive multi producer single consumer queue (Dmitry Vyukov's).  Items embed an MPSCQueueEntry
+ * bound with the SList machinery:
+ *
+ *   struct op
+ *   {
+ *       ptl::MPSCQueueEntry<SLIST_BINDING(op, entry)> entry;
+ *   };
+ *   MAKE_SLIST_BINDING(op, entry);
+ *
+ *   ptl::MPSCQueue<SLIST_BINDING(op, entry)> queue;
+ *
+ * push() is wait free: one exchange and one store, from any thread.  pop() belongs to a single
+ * consumer and is lock free.  It can return nullptr while a producer is between its two steps, even
+ * though that producer's item and later ones are on their way; the consumer is expected to be
+ * woken again by whoever pushed.  The queue never owns, allocates or frees items.
+ */
+template <typename T, typename BIND>
+struct MPSCQueueEntry
+{
+    MPSCQueueEntry()
+        : next_(nullptr)
+    {}
+
+    MPSCQueueEntry(const MPSCQueueEntry&) = delete;
+    MPSCQueueEntry& operator=(const MPSCQueueEntry&) = delete;
+
+private:
+    template <typename Ty, typename B>
+    friend struct MPSCQueue;
+
+    T* from_entry() noexcept
+    {
+        return reinterpret_cast<T*>(reinterpret_cast<uintptr_t>(this) - BIND::offset);
+    }
+
+    std::atomic<MPSCQueueEntry*> next_;
+};
+
+template <typename T, typename BIND>
+struct MPSCQueue
+{
+    using entry_type = MPSCQueueEntry<T, BIND>;
+
+    MPSCQueue() noexcept
+        : head_(&stub_)
+        , tail_(&stub_)
+    {}
+
+    MPSCQueue(const MPSCQueue&) = delete;
+    MPSCQueue& operator=(const MPSCQueue&) = delete;
+
+    ~MPSCQueue()
+    {
+        assert(empty());
+    }
+
+    void push(T* item) noexcept
+    {
+        push(to_entry(item));
+    }
+
+    // consumer only
+    T* pop() noexcept
+    {
+        auto tail = tail_;
+        auto next = tail->next_.load(std::memory_order_acquire);
+        if (tail == &stub_) {
+            if (next == nullptr) {
+                return nullptr;
+            }
+            tail_ = next;
+            tail = next;
+            next = next->next_.load(std::memory_order_acquire);
+        }
+        if (next) {
+            tail_ = next;
+            return tail->from_entry();
+        }
+        if (tail != head_.load(std::memory_order_acquire)) {
+            // a producer has taken head_ but not linked its item yet
+            return nullptr;
+        }
+        // tail is the last item, park the stub behind it so tail can be handed out
+        push(&stub_);
+        next = tail->next_.load(std::memory_order_acquire);
+        if (next) {
+            tail_ = next;
+            return tail->from_entry();
+        }
+        return nullptr;
+    }
+
+    // consumer only, or when no producer is active
+    bool empty() const noexcept
+    {
+        return tail_ == &stub_ && stub_.next_.load(std::memory_order_acquire) == nullptr;
+    }
+
+private:
+    static entry_type* to_entry(T* item) noexcept
+    {
+        return reinterpret_cast<entry_type*>(reinterpret_cast<uintptr_t>(item) + BIND::offset);
+    }
+
+    void push(entry_type* entry) noexcept
+    {
+        entry->next_.store(nullptr, std::memory_order_relaxed);
+        auto prev = head_.exchange(entry, std::memory_order_acq_rel);
+        prev->next_.store(entry, std::memory_order_release);
+    }
+
+    alignas(64) std::atomic<entry_type*> head_;
+    alignas(64) entry_type* tail_;
+    entry_type stub_;
+};
+
+} // namespace ptl
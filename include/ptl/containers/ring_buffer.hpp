@@ -0,0 +1,445 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace ptl {
+
+// A run of elements laid out next to each other, e.g. for an iovec
+template <typename T>
+struct contiguous_span
+{
+    T* data;
+    size_t size;
+};
+
+/* Growable double ended queue over one contiguous allocation.  Elements wrap around a power of two
+ * capacity, so push and pop at either end are O(1) and the capacity doubles when full (amortized
+ * O(1)), moving the elements in order.  Any allocator works, aligned_allocator included.
+ *
+ * The elements are in at most two contiguous runs, contiguous_spans() gives them for a single
+ * writev without copying:
+ *
+ *   auto spans = queue.contiguous_spans();
+ *   ::iovec iov[2] = { { spans[0].data, spans[0].size }, { spans[1].data, spans[1].size } };
+ *
+ * Growing moves the elements, pointers and iterators into the ring do not survive a push.
+ */
+template <typename T, typename ALLOC = std::allocator<T>>
+class ring_buffer
+{
+    using traits = std::allocator_traits<ALLOC>;
+
+    template <typename RING, typename V>
+    class basic_iterator
+    {
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = std::remove_const_t<V>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = V*;
+        using reference = V&;
+
+        basic_iterator() noexcept = default;
+        basic_iterator(RING* ring, size_t index) noexcept
+            : ring_(ring)
+            , index_(index)
+        {}
+        // iterator to const_iterator
+        template <typename R, typename W, typename = std::enable_if_t<std::is_convertible_v<W*, V*>>>
+        basic_iterator(const basic_iterator<R, W>& other) noexcept
+            : ring_(other.ring_)
+            , index_(other.index_)
+        {}
+
+        reference operator*() const noexcept
+        {
+            return (*ring_)[index_];
+        }
+        pointer operator->() const noexcept
+        {
+            return &(*ring_)[index_];
+        }
+        reference operator[](difference_type n) const noexcept
+        {
+            return (*ring_)[index_ + n];
+        }
+
+        basic_iterator& operator++() noexcept
+        {
+            ++index_;
+            return *this;
+        }
+        basic_iterator operator++(int) noexcept
+        {
+            return basic_iterator(ring_, index_++);
+        }
+        basic_iterator& operator--() noexcept
+        {
+            --index_;
+            return *this;
+        }
+        basic_iterator operator--(int) noexcept
+        {
+            return basic_iterator(ring_, index_--);
+        }
+        basic_iterator& operator+=(difference_type n) noexcept
+        {
+            index_ += n;
+            return *this;
+        }
+        basic_iterator& operator-=(difference_type n) noexcept
+        {
+            index_ -= n;
+            return *this;
+        }
+        friend basic_iterator operator+(basic_iterator it, difference_type n) noexcept
+        {
+            return it += n;
+        }
+        friend basic_iterator operator-(basic_iterator it, difference_type n) noexcept
+        {
+            return it -= n;
+        }
+        friend difference_type operator-(const basic_iterator& a, const basic_iterator& b) noexcept
+        {
+            return static_cast<difference_type>(a.index_ - b.index_);
+        }
+
+        friend bool operator==(const basic_iterator& a, const basic_iterator& b) noexcept
+        {
+            return a.index_ == b.index_;
+        }
+        friend bool operator!=(const basic_iterator& a, const basic_iterator& b) noexcept
+        {
+            return a.index_ != b.index_;
+        }
+        friend bool operator<(const basic_iterator& a, const basic_iterator& b) noexcept
+        {
+            return a.index_ < b.index_;
+        }
+
+    private:
+        template <typename R, typename W>
+        friend class basic_iterator;
+
+        RING* ring_ = nullptr;
+        size_t index_ = 0;
+    };
+
+public:
+    using value_type = T;
+    using allocator_type = ALLOC;
+    using size_type = size_t;
+    using reference = T&;
+    using const_reference = const T&;
+    using iterator = basic_iterator<ring_buffer, T>;
+    using const_iterator = basic_iterator<const ring_buffer, const T>;
+
+    ring_buffer() noexcept(std::is_nothrow_default_constructible_v<ALLOC>) = default;
+
+    explicit ring_buffer(const ALLOC& alloc) noexcept
+        : alloc_(alloc)
+    {}
+
+    ring_buffer(ring_buffer&& other) noexcept
+        : alloc_(std::move(other.alloc_))
+        , buffer_(std::exchange(other.buffer_, nullptr))
+        , capacity_(std::exchange(other.capacity_, 0))
+        , head_(std::exchange(other.head_, 0))
+        , size_(std::exchange(other.size_, 0))
+    {}
+
+    ring_buffer& operator=(ring_buffer&& other) noexcept
+    {
+        static_assert(traits::is_always_equal::value || traits::propagate_on_container_move_assignment::value,
+                      "the allocator must move with the memory");
+        if (&other != this) {
+            release();
+            if constexpr (traits::propagate_on_container_move_assignment::value) {
+                alloc_ = std::move(other.alloc_);
+            }
+            buffer_ = std::exchange(other.buffer_, nullptr);
+            capacity_ = std::exchange(other.capacity_, 0);
+            head_ = std::exchange(other.head_, 0);
+            size_ = std::exchange(other.size_, 0);
+        }
+        return *this;
+    }
+
+    ring_buffer(const ring_buffer&) = delete;
+    ring_buffer& operator=(const ring_buffer&) = delete;
+
+    ~ring_buffer()
+    {
+        release();
+    }
+
+    size_type size() const noexcept
+    {
+        return size_;
+    }
+    size_type capacity() const noexcept
+    {
+        return capacity_;
+    }
+    bool empty() const noexcept
+    {
+        return size_ == 0;
+    }
+    allocator_type get_allocator() const noexcept
+    {
+        return alloc_;
+    }
+
+    // Rounded up to a power of two
+    void reserve(size_type n)
+    {
+        if (n > capacity_) {
+            reallocate(round_up(n));
+        }
+    }
+
+    T& operator[](size_type i) noexcept
+    {
+        assert(i < size_);
+        return buffer_[(head_ + i) & (capacity_ - 1)];
+    }
+    const T& operator[](size_type i) const noexcept
+    {
+        assert(i < size_);
+        return buffer_[(head_ + i) & (capacity_ - 1)];
+    }
+
+    T& front() noexcept
+    {
+        return (*this)[0];
+    }
+    const T& front() const noexcept
+    {
+        return (*this)[0];
+    }
+    T& back() noexcept
+    {
+        return (*this)[size_ - 1];
+    }
+    const T& back() const noexcept
+    {
+        return (*this)[size_ - 1];
+    }
+
+    iterator begin() noexcept
+    {
+        return iterator(this, 0);
+    }
+    iterator end() noexcept
+    {
+        return iterator(this, size_);
+    }
+    const_iterator begin() const noexcept
+    {
+        return const_iterator(this, 0);
+    }
+    const_iterator end() const noexcept
+    {
+        return const_iterator(this, size_);
+    }
+
+    template <typename... ARGS>
+    T& emplace_back(ARGS&&... args)
+    {
+        if (size_ == capacity_) {
+            // args may refer to an element
+            T item(std::forward<ARGS>(args)...);
+            grow();
+            return emplace_back(std::move(item));
+        }
+        auto slot = buffer_ + ((head_ + size_) & (capacity_ - 1));
+        traits::construct(alloc_, slot, std::forward<ARGS>(args)...);
+        ++size_;
+        return *slot;
+    }
+
+    template <typename... ARGS>
+    T& emplace_front(ARGS&&... args)
+    {
+        if (size_ == capacity_) {
+            // args may refer to an element
+            T item(std::forward<ARGS>(args)...);
+            grow();
+            return emplace_front(std::move(item));
+        }
+        auto head = (head_ - 1) & (capacity_ - 1);
+        traits::construct(alloc_, buffer_ + head, std::forward<ARGS>(args)...);
+        head_ = head;
+        ++size_;
+        return buffer_[head];
+    }
+
+    void push_back(const T& item)
+    {
+        emplace_back(item);
+    }
+    void push_back(T&& item)
+    {
+        emplace_back(std::move(item));
+    }
+    void push_front(const T& item)
+    {
+        emplace_front(item);
+    }
+    void push_front(T&& item)
+    {
+        emplace_front(std::move(item));
+    }
+
+    void pop_front() noexcept
+    {
+        assert(size_ > 0);
+        traits::destroy(alloc_, buffer_ + head_);
+        head_ = (head_ + 1) & (capacity_ - 1);
+        --size_;
+    }
+
+    void pop_back() noexcept
+    {
+        assert(size_ > 0);
+        --size_;
+        traits::destroy(alloc_, buffer_ + ((head_ + size_) & (capacity_ - 1)));
+    }
+
+    void clear() noexcept
+    {
+        while (size_ > 0) {
+            pop_back();
+        }
+        head_ = 0;
+    }
+
+    // The elements in order, the second span is empty unless they wrap around
+    std::array<contiguous_span<T>, 2> contiguous_spans() noexcept
+    {
+        return spans(buffer_, head_, size_);
+    }
+    std::array<contiguous_span<const T>, 2> contiguous_spans() const noexcept
+    {
+        auto s = spans(buffer_, head_, size_);
+        return { { { s[0].data, s[0].size }, { s[1].data, s[1].size } } };
+    }
+
+protected:
+    static constexpr size_type min_capacity = 8;
+
+    std::array<contiguous_span<T>, 2> spans(T* buffer, size_type from, size_type count) const noexcept
+    {
+        if (count == 0) {
+            return { { { buffer, 0 }, { buffer, 0 } } };
+        }
+        auto first = std::min(count, capacity_ - from);
+        return { { { buffer + from, first }, { buffer, count - first } } };
+    }
+
+    static size_type round_up(size_type n) noexcept
+    {
+        size_type capacity = min_capacity;
+        while (capacity < n) {
+            capacity <<= 1;
+        }
+        return capacity;
+    }
+
+    void grow()
+    {
+        reallocate(capacity_ == 0 ? min_capacity : capacity_ * 2);
+    }
+
+    // Moves the elements to the start of a new buffer, unchanged if an element throws
+    void reallocate(size_type capacity)
+    {
+        auto buffer = traits::allocate(alloc_, capacity);
+        size_type moved = 0;
+        try {
+            for (; moved < size_; ++moved) {
+                traits::construct(alloc_, buffer + moved, std::move_if_noexcept((*this)[moved]));
+            }
+        } catch (...) {
+            while (moved > 0) {
+                traits::destroy(alloc_, buffer + --moved);
+            }
+            traits::deallocate(alloc_, buffer, capacity);
+            throw;
+        }
+
+        auto size = size_;
+        release();
+        buffer_ = buffer;
+        capacity_ = capacity;
+        size_ = size;
+    }
+
+    void release() noexcept
+    {
+        clear();
+        if (buffer_ != nullptr) {
+            traits::deallocate(alloc_, buffer_, capacity_);
+            buffer_ = nullptr;
+            capacity_ = 0;
+        }
+    }
+
+    ALLOC alloc_;
+    T* buffer_ = nullptr;
+    size_type capacity_ = 0;
+    size_type head_ = 0;
+    size_type size_ = 0;
+};
+
+/* Byte ring used as a socket receive buffer: the free space is handed out for the reads to land in
+ * directly, the parser consumes from the front.
+ *
+ *   auto space = buffer.prepare(4096);
+ *   auto n = co_await socket.recv_some(space[0].data, space[0].size);
+ *   buffer.commit(n);
+ *   ...
+ *   buffer.consume(parsed);
+ */
+template <typename ALLOC = std::allocator<uint8_t>>
+class byte_ring_buffer : public ring_buffer<uint8_t, ALLOC>
+{
+    using base = ring_buffer<uint8_t, ALLOC>;
+
+public:
+    using base::base;
+
+    // Free space for at least n bytes after the content, in at most two runs
+    std::array<contiguous_span<uint8_t>, 2> prepare(size_t n)
+    {
+        if (this->capacity_ - this->size_ < n) {
+            this->reserve(this->size_ + n);
+        }
+        return this->spans(this->buffer_, (this->head_ + this->size_) & (this->capacity_ - 1), this->capacity_ - this->size_);
+    }
+
+    // Appends n bytes written to the space given by prepare()
+    void commit(size_t n) noexcept
+    {
+        assert(n <= this->capacity_ - this->size_);
+        this->size_ += n;
+    }
+
+    // Drops n bytes from the front
+    void consume(size_t n) noexcept
+    {
+        assert(n <= this->size_);
+        this->size_ -= n;
+        this->head_ = this->size_ == 0 ? 0 : (this->head_ + n) & (this->capacity_ - 1);
+    }
+};
+
+} // namespace ptl
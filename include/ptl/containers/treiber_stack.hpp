@@ -0,0 +1,113 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include "ptl/containers/slist.hpp"
+#include "ptl/packed_ptr.hpp"
+
+namespace ptl {
+
+/* Intrusive lock-free LIFO (Treiber stack), usable from any number of threads on both ends.  Items
+ * embed a TreiberStackEntry bound with the SList machinery:
+ *
+ *   struct block
+ *   {
+ *       ptl::TreiberStackEntry<SLIST_BINDING(block, entry)> entry;
+ *   };
+ *   MAKE_SLIST_BINDING(block, entry);
+ *
+ *   ptl::TreiberStack<SLIST_BINDING(block, entry)> free_list;
+ *
+ * The head carries a 16 bit tag bumped by every pop, so an item popped and pushed back between
+ * another thread's load and compare-exchange does not fool it (ABA).  A concurrent pop may still
+ * read the link of an item that was just taken, items must therefore stay mapped while the stack is
+ * in use: this is meant for free-lists and pools that recycle their memory, not for stacks whose
+ * popped items are freed.
+ */
+template <typename T, typename BIND>
+struct TreiberStackEntry
+{
+    TreiberStackEntry()
+        : next_(nullptr)
+    {}
+
+    TreiberStackEntry(const TreiberStackEntry&) = delete;
+    TreiberStackEntry& operator=(const TreiberStackEntry&) = delete;
+
+private:
+    template <typename Ty, typename B>
+    friend struct TreiberStack;
+
+    T* from_entry() noexcept
+    {
+        return reinterpret_cast<T*>(reinterpret_cast<uintptr_t>(this) - BIND::offset);
+    }
+
+    std::atomic<TreiberStackEntry*> next_;
+};
+
+template <typename T, typename BIND>
+struct TreiberStack
+{
+    using entry_type = TreiberStackEntry<T, BIND>;
+
+    TreiberStack() noexcept = default;
+
+    TreiberStack(const TreiberStack&) = delete;
+    TreiberStack& operator=(const TreiberStack&) = delete;
+
+    void push(T* item) noexcept
+    {
+        auto entry = to_entry(item);
+        auto [head, tag] = head_.load(std::memory_order_relaxed);
+        do {
+            entry->next_.store(head, std::memory_order_relaxed);
+        } while (!head_.compare_exchange_weak(head, tag, entry, tag, std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    T* pop() noexcept
+    {
+        auto [head, tag] = head_.load(std::memory_order_acquire);
+        while (head) {
+            auto next = head->next_.load(std::memory_order_relaxed);
+            if (head_.compare_exchange_weak(head, tag, next, static_cast<uint16_t>(tag + 1),
+                                            std::memory_order_acquire, std::memory_order_acquire)) {
+                return head->from_entry();
+            }
+        }
+        return nullptr;
+    }
+
+    // Takes every item at once, in LIFO order; follow them with next()
+    T* pop_all() noexcept
+    {
+        auto [head, tag] = head_.load(std::memory_order_relaxed);
+        while (!head_.compare_exchange_weak(head, tag, nullptr, static_cast<uint16_t>(tag + 1),
+                                            std::memory_order_acquire, std::memory_order_relaxed)) {
+        }
+        return head ? head->from_entry() : nullptr;
+    }
+
+    // The item after one returned by pop_all()
+    static T* next(T* item) noexcept
+    {
+        auto next = to_entry(item)->next_.load(std::memory_order_relaxed);
+        return next ? next->from_entry() : nullptr;
+    }
+
+    bool empty() const noexcept
+    {
+        return head_.get(std::memory_order_relaxed) == nullptr;
+    }
+
+private:
+    static entry_type* to_entry(T* item) noexcept
+    {
+        return reinterpret_cast<entry_type*>(reinterpret_cast<uintptr_t>(item) + BIND::offset);
+    }
+
+    AtomicPackedPtr<entry_type, uint16_t> head_;
+};
+
+} // namespace ptl
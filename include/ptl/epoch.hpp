@@ -0,0 +1,254 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace ptl::epoch {
+
+/* Epoch based reclamation.  Readers pin the current epoch with a guard for as long as they use
+ * pointers loaded from shared structures; writers unlink an object, then retire() it instead of
+ * freeing it.  The global epoch only moves on once every pinned thread has seen it, so an object
+ * retired in epoch e is reclaimed once the epoch reaches e + 2: no guard that could have seen it is
+ * left by then.
+ *
+ *   {
+ *       ptl::epoch::guard g;
+ *       auto config = current.load(g);      // no reference count touched
+ *       use(config->field);
+ *   }
+ *
+ * Guards nest and are cheap: a thread local counter, a store and a fence.  Retired objects wait in
+ * the retiring thread, every 64 retirements it tries to move the epoch and reclaims what it can;
+ * a thread that exits hands its leftovers to the next one that collects.  A guard held forever
+ * stops all reclamation.
+ */
+namespace detail {
+
+struct retired
+{
+    void* ptr;
+    void (*reclaim)(void*) noexcept;
+    uint64_t epoch;
+};
+
+struct participant
+{
+    // epoch << 1 | pinned
+    std::atomic<uint64_t> state{ 0 };
+    std::atomic<bool> in_use{ true };
+    participant* next = nullptr;
+
+    // owner thread only
+    uint32_t nesting = 0;
+    std::vector<retired> retired_list;
+};
+
+class domain
+{
+public:
+    static constexpr size_t collect_threshold = 64;
+
+    // Never destroyed, threads may still leave it during static destruction
+    static domain& instance()
+    {
+        static domain* global = new domain;
+        return *global;
+    }
+
+    participant* enter()
+    {
+        for (auto p = participants_.load(std::memory_order_acquire); p != nullptr; p = p->next) {
+            bool used = false;
+            if (p->in_use.compare_exchange_strong(used, true, std::memory_order_acquire, std::memory_order_relaxed)) {
+                return p;
+            }
+        }
+        auto p = new participant;
+        p->next = participants_.load(std::memory_order_relaxed);
+        while (!participants_.compare_exchange_weak(p->next, p, std::memory_order_release, std::memory_order_relaxed)) {
+        }
+        return p;
+    }
+
+    void leave(participant* p)
+    {
+        if (!p->retired_list.empty()) {
+            std::scoped_lock lock(orphans_lock_);
+            orphans_.insert(orphans_.end(), p->retired_list.begin(), p->retired_list.end());
+            p->retired_list.clear();
+        }
+        p->in_use.store(false, std::memory_order_release);
+    }
+
+    void pin(participant& p) noexcept
+    {
+        if (p.nesting++ == 0) {
+            auto e = epoch_.load(std::memory_order_relaxed);
+            p.state.store(e << 1 | 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+        }
+    }
+
+    void unpin(participant& p) noexcept
+    {
+        if (--p.nesting == 0) {
+            p.state.store(p.state.load(std::memory_order_relaxed) & ~uint64_t(1), std::memory_order_release);
+        }
+    }
+
+    void retire(participant& p, void* ptr, void (*reclaim)(void*) noexcept)
+    {
+        // the object was unlinked before the epoch is read
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        p.retired_list.push_back({ ptr, reclaim, epoch_.load(std::memory_order_relaxed) });
+        if (p.retired_list.size() % collect_threshold == 0) {
+            collect(p);
+        }
+    }
+
+    // true when p and the orphans have nothing left to reclaim
+    bool collect(participant& p)
+    {
+        try_advance();
+        auto epoch = epoch_.load(std::memory_order_acquire);
+
+        // reclaiming may retire more
+        std::vector<retired> mine;
+        mine.swap(p.retired_list);
+        reclaim(mine, epoch);
+        if (p.retired_list.empty()) {
+            p.retired_list.swap(mine);
+        } else {
+            p.retired_list.insert(p.retired_list.end(), mine.begin(), mine.end());
+        }
+
+        bool orphans_left = false;
+        std::unique_lock lock(orphans_lock_, std::try_to_lock);
+        if (lock.owns_lock()) {
+            std::vector<retired> orphans;
+            orphans.swap(orphans_);
+            lock.unlock();
+            reclaim(orphans, epoch);
+            if (!orphans.empty()) {
+                lock.lock();
+                orphans_.insert(orphans_.end(), orphans.begin(), orphans.end());
+                orphans_left = true;
+            }
+        } else {
+            orphans_left = true;
+        }
+        return p.retired_list.empty() && !orphans_left;
+    }
+
+private:
+    // Moves the epoch on if every pinned thread is in the current one
+    void try_advance() noexcept
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        auto epoch = epoch_.load(std::memory_order_relaxed);
+        for (auto p = participants_.load(std::memory_order_acquire); p != nullptr; p = p->next) {
+            // acquire what unpinned readers did under their guards
+            auto state = p->state.load(std::memory_order_acquire);
+            if ((state & 1) && (state >> 1) != epoch) {
+                return;
+            }
+        }
+        epoch_.compare_exchange_strong(epoch, epoch + 1, std::memory_order_release, std::memory_order_relaxed);
+    }
+
+    static void reclaim(std::vector<retired>& list, uint64_t epoch) noexcept
+    {
+        size_t kept = 0;
+        for (auto& r : list) {
+            if (r.epoch + 2 <= epoch) {
+                r.reclaim(r.ptr);
+            } else {
+                list[kept++] = r;
+            }
+        }
+        list.resize(kept);
+    }
+
+    std::atomic<uint64_t> epoch_{ 0 };
+    std::atomic<participant*> participants_{ nullptr };
+
+    std::mutex orphans_lock_;
+    std::vector<retired> orphans_;
+};
+
+inline participant& this_thread()
+{
+    struct registration
+    {
+        ~registration()
+        {
+            if (p != nullptr) {
+                domain::instance().leave(p);
+            }
+        }
+
+        participant* p = nullptr;
+    };
+
+    static thread_local registration self;
+    if (self.p == nullptr) {
+        self.p = domain::instance().enter();
+    }
+    return *self.p;
+}
+
+} // namespace detail
+
+// Pins the current epoch: nothing retired from now on is reclaimed while the guard lives
+class guard
+{
+public:
+    guard()
+        : participant_(detail::this_thread())
+    {
+        detail::domain::instance().pin(participant_);
+    }
+
+    ~guard()
+    {
+        detail::domain::instance().unpin(participant_);
+    }
+
+    guard(const guard&) = delete;
+    guard& operator=(const guard&) = delete;
+
+private:
+    detail::participant& participant_;
+};
+
+// Calls reclaim(ptr) once no guard that may have seen ptr is left, ptr must be unlinked already
+inline void retire(void* ptr, void (*reclaim)(void*) noexcept)
+{
+    detail::domain::instance().retire(detail::this_thread(), ptr, reclaim);
+}
+
+template <typename T>
+void retire(T* ptr)
+{
+    retire(static_cast<void*>(ptr), [](void* p) noexcept { delete static_cast<T*>(p); });
+}
+
+// Reclaims what can be, true when nothing retired is left waiting
+inline bool collect()
+{
+    return detail::domain::instance().collect(detail::this_thread());
+}
+
+// Waits until everything this thread retired, and every exited thread's leftovers, is reclaimed.
+// The calling thread must not hold a guard.
+inline void synchronize()
+{
+    while (!collect()) {
+        std::this_thread::yield();
+    }
+}
+
+} // namespace ptl::epoch
@@ -96,6 +96,9 @@ struct int_bit_traits<void*>
     static constexpr uintptr_t MASK = ((1ULL << BITS) - 1) << SHIFT;
 };
 
+template<typename T>
+struct int_bit_traits<T*> : int_bit_traits<void*> {};
+
 template<>
 struct int_bit_traits<std::exception_ptr> : int_bit_traits<void*> {};
 
@@ -1,29 +1,128 @@
 #pragma once
+#include <atomic>
 #include <condition_variable>
 #include <mutex>
 #include <queue>
 #include <functional>
 
-// FIXME: find a home:
-template <typename LOCK, typename LAMBDA>
-void synchronize(LOCK& lock, LAMBDA lambda)
-{
-    std::scoped_lock sl(lock);
-    lambda();
-}
+#include "ptl/execution/cooperative_budget.hpp"
+#include "ptl/synchronize.hpp"
 
 namespace ptl::execution {
 
+// Intrusive unit of work.  It is embedded in whatever needs to be scheduled (a coroutine promise,
+// an awaiter) so posting it to an executor neither allocates nor type-erases a callable.
+struct work_item
+{
+    using function_type = void (*)(work_item*) noexcept;
+
+    explicit work_item(function_type fn) noexcept
+        : next_(nullptr)
+        , execute_(fn)
+    {}
+
+    void execute() noexcept
+    {
+        execute_(this);
+    }
+
+    work_item* next_;
+    function_type execute_;
+};
+
+// Lock-free intrusive queue of work items: any thread pushes, one consumer runs them in push order
+class work_queue
+{
+public:
+    work_queue() noexcept
+        : head_(nullptr)
+    {}
+
+    work_queue(const work_queue&) = delete;
+    work_queue& operator=(const work_queue&) = delete;
+
+    // true when the queue was empty, i.e. when its consumer may be idle
+    bool push(work_item& item) noexcept
+    {
+        auto head = head_.load(std::memory_order_relaxed);
+        do {
+            item.next_ = head;
+        } while (!head_.compare_exchange_weak(head, &item, std::memory_order_release, std::memory_order_relaxed));
+        return head == nullptr;
+    }
+
+    bool empty() const noexcept
+    {
+        return head_.load(std::memory_order_acquire) == nullptr;
+    }
+
+    // Executes everything pushed so far, every item starts with a full cooperative budget
+    size_t run() noexcept
+    {
+        auto item = head_.exchange(nullptr, std::memory_order_acquire);
+
+        work_item* fifo = nullptr;
+        while (item) {
+            auto next = item->next_;
+            item->next_ = fifo;
+            fifo = item;
+            item = next;
+        }
+
+        size_t count = 0;
+        while (fifo) {
+            // the item may be reused as soon as it executes
+            auto next = fifo->next_;
+            cooperative_budget::refill();
+            fifo->execute();
+            fifo = next;
+            count++;
+        }
+        return count;
+    }
+
+private:
+    std::atomic<work_item*> head_;
+};
+
 class Executor
 {
 public:
-    Executor() { current = this; }
+    Executor()
+    {
+        current = this;
+    }
     virtual ~Executor() { current = nullptr; }
 
     virtual void add(std::function<void()> fn) = 0;
 
+    // Lock-free and allocation free.  The executor is only woken (the one virtual call) when the
+    // posted list goes from empty to non-empty, i.e. when it may be idle.
+    void post(work_item& item) noexcept
+    {
+        if (posted_.push(item)) {
+            wake();
+        }
+    }
 
     static inline thread_local Executor* current;
+
+protected:
+    virtual void wake() noexcept = 0;
+
+    bool has_posted() const noexcept
+    {
+        return !posted_.empty();
+    }
+
+    // Executes everything posted so far, in posting order
+    size_t run_posted() noexcept
+    {
+        return posted_.run();
+    }
+
+private:
+    work_queue posted_;
 };
 
 class QueuedExecutor : public Executor
@@ -33,20 +132,26 @@ public:
 
     void run() {
         while (true) {
+            run_posted();
+
             std::function<void()> fn;
 
             {
                 std::unique_lock<std::mutex> sl(lock_);
-                cv_.wait(sl, [&](){ return finished_ || !work_.empty(); });
+                cv_.wait(sl, [&](){ return finished_ || !work_.empty() || has_posted(); });
 
-                if (work_.empty() && finished_) {
-                    return;
+                if (work_.empty()) {
+                    if (finished_ && !has_posted()) {
+                        return;
+                    }
+                    continue;
                 }
 
                 fn = work_.front();
                 work_.pop();
             }
 
+            cooperative_budget::refill();
             fn();
         }
     }
@@ -54,15 +159,24 @@ public:
     void add(std::function<void()> fn) override {
         synchronize(lock_, [&](){
             work_.push(fn);
+            cv_.notify_one();
         });
-        cv_.notify_one();
     }
 
     void stop() {
+        // notify under the lock, here and above: once run() returns the executor may be destroyed
         synchronize(lock_, [&](){
             finished_ = true;
+            cv_.notify_one();
+        });
+    }
+
+protected:
+    void wake() noexcept override {
+        // taking the lock orders us with a run() that is about to wait
+        synchronize(lock_, [&](){
+            cv_.notify_one();
         });
-        cv_.notify_one();
     }
 
 private:
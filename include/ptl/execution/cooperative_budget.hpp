@@ -0,0 +1,33 @@
+#pragma once
+
+namespace ptl::execution {
+
+/* Number of operations a coroutine may complete inline before it has to give its thread away.
+ * The budget belongs to the thread and is refilled every time the thread goes back to whatever
+ * drives it (io_service loop, executor queue), so in effect it is the budget of the task running.
+ */
+class cooperative_budget
+{
+public:
+    static constexpr unsigned initial = 64;
+
+    static void refill() noexcept
+    {
+        remaining_ = initial;
+    }
+
+    // false once the budget is spent
+    static bool consume() noexcept
+    {
+        if (remaining_ == 0) {
+            return false;
+        }
+        --remaining_;
+        return true;
+    }
+
+private:
+    static inline thread_local unsigned remaining_ = initial;
+};
+
+} // namespace ptl::execution
@@ -1,15 +1,161 @@
 #pragma once
+#include <cassert>
+#include <cstdint>
+#include <stdexcept>
 #include <type_traits>
+#include <utility>
+#include <functional>
+#include "ptl/compiler.hpp"
 #include "ptl/type_safe/crtp.hpp"
 #include "ptl/packed_ptr.hpp"
 #include "ptl/error.hpp"
 
 namespace ptl {
+
+struct error_policy_assert {};
+struct error_policy_throw {};
+
+template <typename T, typename E, typename EPOLICY, typename STORAGE>
+struct expected;
+
+// Value and error share a union next to a discriminant, any T and E
+struct expected_storage_union {};
+// For trivially copyable T and E: expected is trivially copyable too, and so returned in registers.
+// When T fits in the low 62 bits of a word (void, pointers, 32 bit values) and E in the low 32 bits,
+// the discriminant goes in the top two bits and the whole expected is a single word.
+struct expected_storage_compact {};
+
 namespace detail {
 
+template <typename T, typename = void>
+struct expected_value_mask
+{
+    static constexpr uint64_t value = sizeof(T) <= sizeof(uint32_t) ? 0xffffffffULL : ~0ULL;
+};
+template <typename T>
+struct expected_value_mask<T, std::void_t<decltype(int_bit_traits<T>::MASK)>>
+{
+    static constexpr uint64_t value = int_bit_traits<T>::MASK;
+};
+template <>
+struct expected_value_mask<void>
+{
+    static constexpr uint64_t value = 0;
+};
+
+template <typename T>
+constexpr bool expected_trivial_v = std::is_void_v<T> || (std::is_trivially_copyable_v<T> && std::is_trivially_destructible_v<T>);
+
+template <typename T>
+constexpr size_t expected_size_v = sizeof(T);
+template <>
+constexpr size_t expected_size_v<void> = 0;
+
+template <typename T, typename E>
+constexpr bool expected_fits_word_v = __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+                                      && expected_size_v<T> <= sizeof(uint64_t)
+                                      && (expected_value_mask<T>::value >> 62) == 0
+                                      && sizeof(E) <= sizeof(uint32_t);
+
+template <typename T, typename E>
+using expected_default_storage = std::conditional_t<!std::is_reference_v<T> && expected_trivial_v<std::decay_t<T>> && expected_trivial_v<E>,
+                                                    expected_storage_compact, expected_storage_union>;
+
+} // namespace detail
+
+namespace detail {
+
+template <typename EXPECTED>
+struct expected_traits;
+
+template <typename T, typename E, typename EPOLICY, typename STORAGE>
+struct expected_traits<expected<T, E, EPOLICY, STORAGE>>
+{
+    using value_type = T;
+    using error_type = E;
+    using policy = EPOLICY;
+};
+
+template <typename T>
+using expected_remove_cvref_t = std::remove_cv_t<std::remove_reference_t<T>>;
+
+/* Monadic operations shared by every expected.  Called on an rvalue they move the value or the
+ * error into the continuation, on an lvalue they pass it by reference; either way the expected
+ * itself is never copied.  They are force-inlined so a chain folds into the branches it stands for.
+ *
+ *   and_then(f)         f(value) -> expected<U, E>, errors pass through
+ *   transform(f)        f(value) -> U, wrapped as expected<U, E>
+ *   or_else(f)          f(error) -> expected<T, G>, values pass through
+ *   transform_error(f)  f(error) -> G, wrapped as expected<T, G>
+ *
+ * For expected<void, E> the value continuations take no argument.
+ */
 template <typename DERIVED>
 struct expected_base
 {
+    template <typename F>
+    PTL_FORCE_INLINE auto and_then(F&& f) &
+    {
+        return and_then_impl(self(), std::forward<F>(f));
+    }
+    template <typename F>
+    PTL_FORCE_INLINE auto and_then(F&& f) const &
+    {
+        return and_then_impl(self(), std::forward<F>(f));
+    }
+    template <typename F>
+    PTL_FORCE_INLINE auto and_then(F&& f) &&
+    {
+        return and_then_impl(std::move(self()), std::forward<F>(f));
+    }
+
+    template <typename F>
+    PTL_FORCE_INLINE auto transform(F&& f) &
+    {
+        return transform_impl(self(), std::forward<F>(f));
+    }
+    template <typename F>
+    PTL_FORCE_INLINE auto transform(F&& f) const &
+    {
+        return transform_impl(self(), std::forward<F>(f));
+    }
+    template <typename F>
+    PTL_FORCE_INLINE auto transform(F&& f) &&
+    {
+        return transform_impl(std::move(self()), std::forward<F>(f));
+    }
+
+    template <typename F>
+    PTL_FORCE_INLINE auto or_else(F&& f) &
+    {
+        return or_else_impl(self(), std::forward<F>(f));
+    }
+    template <typename F>
+    PTL_FORCE_INLINE auto or_else(F&& f) const &
+    {
+        return or_else_impl(self(), std::forward<F>(f));
+    }
+    template <typename F>
+    PTL_FORCE_INLINE auto or_else(F&& f) &&
+    {
+        return or_else_impl(std::move(self()), std::forward<F>(f));
+    }
+
+    template <typename F>
+    PTL_FORCE_INLINE auto transform_error(F&& f) &
+    {
+        return transform_error_impl(self(), std::forward<F>(f));
+    }
+    template <typename F>
+    PTL_FORCE_INLINE auto transform_error(F&& f) const &
+    {
+        return transform_error_impl(self(), std::forward<F>(f));
+    }
+    template <typename F>
+    PTL_FORCE_INLINE auto transform_error(F&& f) &&
+    {
+        return transform_error_impl(std::move(self()), std::forward<F>(f));
+    }
 
 protected:
     enum class Contains
@@ -18,15 +164,124 @@ protected:
         UNEXPECTED,
         NOTHING
     };
+
+private:
+    using value_type = typename expected_traits<DERIVED>::value_type;
+    using error_type = typename expected_traits<DERIVED>::error_type;
+    using policy = typename expected_traits<DERIVED>::policy;
+
+    DERIVED& self() noexcept
+    {
+        return static_cast<DERIVED&>(*this);
+    }
+    const DERIVED& self() const noexcept
+    {
+        return static_cast<const DERIVED&>(*this);
+    }
+
+    // value() && would leave a moved-from value nobody destroys, move out of the lvalue instead
+    template <typename SELF>
+    PTL_FORCE_INLINE static decltype(auto) forward_value(SELF&& e)
+    {
+        if constexpr (std::is_lvalue_reference_v<SELF> || std::is_reference_v<value_type>) {
+            return e.value();
+        } else {
+            return std::move(e.value());
+        }
+    }
+
+    template <typename SELF>
+    PTL_FORCE_INLINE static decltype(auto) forward_error(SELF&& e)
+    {
+        if constexpr (std::is_lvalue_reference_v<SELF>) {
+            return e.error();
+        } else {
+            return std::move(e.error());
+        }
+    }
+
+    template <typename SELF, typename F>
+    PTL_FORCE_INLINE static auto and_then_impl(SELF&& e, F&& f)
+    {
+        if constexpr (std::is_void_v<value_type>) {
+            using result_type = expected_remove_cvref_t<std::invoke_result_t<F>>;
+            if (e.is_error()) {
+                return result_type(forward_error(std::forward<SELF>(e)));
+            }
+            return std::invoke(std::forward<F>(f));
+        } else {
+            using result_type = expected_remove_cvref_t<std::invoke_result_t<F, decltype(forward_value(std::forward<SELF>(e)))>>;
+            if (e.is_error()) {
+                return result_type(forward_error(std::forward<SELF>(e)));
+            }
+            return std::invoke(std::forward<F>(f), forward_value(std::forward<SELF>(e)));
+        }
+    }
+
+    template <typename SELF, typename F>
+    PTL_FORCE_INLINE static auto transform_impl(SELF&& e, F&& f)
+    {
+        if constexpr (std::is_void_v<value_type>) {
+            using value_result = std::remove_cv_t<std::invoke_result_t<F>>;
+            using result_type = expected<value_result, error_type, policy, expected_default_storage<value_result, error_type>>;
+            if (e.is_error()) {
+                return result_type(forward_error(std::forward<SELF>(e)));
+            }
+            if constexpr (std::is_void_v<value_result>) {
+                std::invoke(std::forward<F>(f));
+                return result_type();
+            } else {
+                return result_type(std::invoke(std::forward<F>(f)));
+            }
+        } else {
+            using value_result = std::remove_cv_t<std::invoke_result_t<F, decltype(forward_value(std::forward<SELF>(e)))>>;
+            using result_type = expected<value_result, error_type, policy, expected_default_storage<value_result, error_type>>;
+            if (e.is_error()) {
+                return result_type(forward_error(std::forward<SELF>(e)));
+            }
+            if constexpr (std::is_void_v<value_result>) {
+                std::invoke(std::forward<F>(f), forward_value(std::forward<SELF>(e)));
+                return result_type();
+            } else {
+                return result_type(std::invoke(std::forward<F>(f), forward_value(std::forward<SELF>(e))));
+            }
+        }
+    }
+
+    template <typename SELF, typename F>
+    PTL_FORCE_INLINE static auto or_else_impl(SELF&& e, F&& f)
+    {
+        using result_type = expected_remove_cvref_t<std::invoke_result_t<F, decltype(forward_error(std::forward<SELF>(e)))>>;
+        if (e.is_error()) {
+            return std::invoke(std::forward<F>(f), forward_error(std::forward<SELF>(e)));
+        }
+        if constexpr (std::is_void_v<value_type>) {
+            return result_type();
+        } else {
+            return result_type(forward_value(std::forward<SELF>(e)));
+        }
+    }
+
+    template <typename SELF, typename F>
+    PTL_FORCE_INLINE static auto transform_error_impl(SELF&& e, F&& f)
+    {
+        using error_result = std::remove_cv_t<std::invoke_result_t<F, decltype(forward_error(std::forward<SELF>(e)))>>;
+        using result_type = expected<value_type, error_result, policy, expected_default_storage<value_type, error_result>>;
+        if (e.is_error()) {
+            return result_type(std::invoke(std::forward<F>(f), forward_error(std::forward<SELF>(e))));
+        }
+        if constexpr (std::is_void_v<value_type>) {
+            return result_type();
+        } else {
+            return result_type(forward_value(std::forward<SELF>(e)));
+        }
+    }
 };
 
 } // namespace detail
 
-struct error_policy_assert {};
-struct error_policy_throw {};
-
-template <typename T, typename E, typename EPOLICY = error_policy_assert>
-struct expected : public detail::expected_base<expected<T, E>>
+template <typename T, typename E, typename EPOLICY = error_policy_assert, typename STORAGE = detail::expected_default_storage<T, E>>
+struct expected : public detail::expected_base<expected<T, E, EPOLICY, STORAGE>>
 {
     //static_assert(!std::is_reference<T>::value, "Expected cannot wrap a reference");
     static_assert(!std::is_same_v<E, std::exception_ptr> || !std::is_same_v<EPOLICY, error_policy_assert>, "std::exception_ptr requires error_policy_throw");
@@ -49,7 +304,7 @@ public:
     template <typename... ARGS>
     expected(std::in_place_t, ARGS &&... args) noexcept(std::is_nothrow_constructible_v<type, ARGS...>)
         : contains_(Contains::EXPECTED)
-        , value_(std::forward<ARGS>...)
+        , value_(std::forward<ARGS>(args)...)
     {}
 
     expected(const E &e) noexcept(std::is_nothrow_copy_constructible_v<E>)
@@ -178,7 +433,7 @@ protected:
     }
 
 private:
-    using Contains = typename detail::expected_base<expected<T, E>>::Contains;
+    using Contains = typename detail::expected_base<expected>::Contains;
 
     Contains contains_;
     union {
@@ -207,8 +462,8 @@ private:
     }
 };
 
-template <typename T, typename E, typename EPOLICY>
-struct expected<T&, E, EPOLICY> : public detail::expected_base<expected<T, E>>
+template <typename T, typename E, typename EPOLICY, typename STORAGE>
+struct expected<T&, E, EPOLICY, STORAGE> : public detail::expected_base<expected<T&, E, EPOLICY, STORAGE>>
 {
     //static_assert(!std::is_reference<T>::value, "Expected cannot wrap a reference");
     static_assert(!std::is_same_v<E, std::exception_ptr> || !std::is_same_v<EPOLICY, error_policy_assert>, "std::exception_ptr requires error_policy_throw");
@@ -349,7 +604,7 @@ protected:
     }
 
 private:
-    using Contains = typename detail::expected_base<expected<T, E>>::Contains;
+    using Contains = typename detail::expected_base<expected>::Contains;
 
     Contains contains_;
     union {
@@ -379,7 +634,7 @@ private:
 };
 
 template <typename E, typename EPOLICY>
-struct expected<void, E, EPOLICY> : public detail::expected_base<expected<void, E>>
+struct expected<void, E, EPOLICY, expected_storage_union> : public detail::expected_base<expected<void, E, EPOLICY, expected_storage_union>>
 {
     static_assert(!std::is_same_v<E, std::exception_ptr> || !std::is_same_v<EPOLICY, error_policy_assert>, "std::exception_ptr requires error_policy_throw");
 public:
@@ -475,7 +730,7 @@ protected:
     }
 
 private:
-    using Contains = typename detail::expected_base<expected<void, E>>::Contains;
+    using Contains = typename detail::expected_base<expected>::Contains;
 
     Contains contains_;
     union {
@@ -503,6 +758,225 @@ private:
     }
 };
 
+namespace detail {
+
+struct expected_no_value {};
+
+// The whole expected in one word: value or error in the low bytes, the discriminant in the top two bits
+template <typename T, typename E>
+struct expected_word_repr
+{
+    using value_type = std::conditional_t<std::is_void_v<T>, expected_no_value, T>;
+    static constexpr int tag_shift = 62;
+
+    expected_word_repr() noexcept
+    {}
+
+    template <typename CONTAINS>
+    CONTAINS contains() const noexcept
+    {
+        return static_cast<CONTAINS>(word_ >> tag_shift);
+    }
+
+    template <typename CONTAINS>
+    void set_nothing(CONTAINS nothing) noexcept
+    {
+        word_ = static_cast<uint64_t>(nothing) << tag_shift;
+    }
+
+    template <typename CONTAINS>
+    void set_value(const value_type& v, CONTAINS expected) noexcept
+    {
+        // the expected tag is zero, values never reach the top bits
+        static_assert(static_cast<uint64_t>(CONTAINS::EXPECTED) == 0);
+        word_ = 0;
+        value_ = v;
+        assert((word_ >> tag_shift) == static_cast<uint64_t>(expected));
+    }
+
+    template <typename CONTAINS>
+    void set_error(const E& e, CONTAINS unexpected) noexcept
+    {
+        word_ = 0;
+        error_ = e;
+        word_ |= static_cast<uint64_t>(unexpected) << tag_shift;
+    }
+
+    union {
+        uint64_t word_;
+        value_type value_;
+        E error_;
+    };
+};
+
+// Too big for a word: a trivially copyable union and discriminant
+template <typename T, typename E, typename CONTAINS>
+struct expected_tagged_repr
+{
+    using value_type = std::conditional_t<std::is_void_v<T>, expected_no_value, T>;
+
+    expected_tagged_repr() noexcept
+    {}
+
+    template <typename C>
+    C contains() const noexcept
+    {
+        return contains_;
+    }
+
+    void set_nothing(CONTAINS nothing) noexcept
+    {
+        contains_ = nothing;
+    }
+
+    void set_value(const value_type& v, CONTAINS expected) noexcept
+    {
+        contains_ = expected;
+        value_ = v;
+    }
+
+    void set_error(const E& e, CONTAINS unexpected) noexcept
+    {
+        contains_ = unexpected;
+        error_ = e;
+    }
+
+    CONTAINS contains_;
+    union {
+        value_type value_;
+        E error_;
+    };
+};
+
+} // namespace detail
+
+// Trivially copyable T (or void) and E: no special members, one or two registers
+template <typename T, typename E, typename EPOLICY>
+struct expected<T, E, EPOLICY, expected_storage_compact> : public detail::expected_base<expected<T, E, EPOLICY, expected_storage_compact>>
+{
+    static_assert(detail::expected_trivial_v<T> && detail::expected_trivial_v<E>, "compact storage requires trivially copyable T and E");
+
+private:
+    using Contains = typename detail::expected_base<expected>::Contains;
+    using repr_type = std::conditional_t<detail::expected_fits_word_v<T, E>, detail::expected_word_repr<T, E>,
+                                         detail::expected_tagged_repr<T, E, Contains>>;
+
+public:
+    using type = typename repr_type::value_type;
+
+    expected() noexcept
+    {
+        repr_.set_nothing(Contains::NOTHING);
+    }
+
+    template <typename U = T, typename = std::enable_if_t<!std::is_void_v<U>>>
+    expected(const type& v) noexcept
+    {
+        repr_.set_value(v, Contains::EXPECTED);
+    }
+    template <typename... ARGS, typename U = T, typename = std::enable_if_t<!std::is_void_v<U>>>
+    expected(std::in_place_t, ARGS&&... args) noexcept(std::is_nothrow_constructible_v<type, ARGS...>)
+    {
+        repr_.set_value(type(std::forward<ARGS>(args)...), Contains::EXPECTED);
+    }
+
+    expected(const E& e) noexcept
+    {
+        repr_.set_error(e, Contains::UNEXPECTED);
+    }
+
+    template <typename U = T, typename = std::enable_if_t<!std::is_void_v<U>>>
+    bool is_value() const noexcept
+    {
+        return contains() == Contains::EXPECTED;
+    }
+    bool is_error() const noexcept
+    {
+        return contains() == Contains::UNEXPECTED;
+    }
+
+    // an expected<void> holding no error is a success
+    template <typename U = T, std::enable_if_t<std::is_void_v<U>, int> = 0>
+    void value() const noexcept(!error_policy_throws())
+    {
+        enforce(Contains::NOTHING);
+    }
+
+    template <typename U = T, std::enable_if_t<!std::is_void_v<U>, int> = 0>
+    type& value() & noexcept(!error_policy_throws())
+    {
+        enforce(Contains::EXPECTED);
+        return repr_.value_;
+    }
+
+    // trivially copyable, moving out is a copy
+    template <typename U = T, std::enable_if_t<!std::is_void_v<U>, int> = 0>
+    type value() && noexcept(!error_policy_throws())
+    {
+        enforce(Contains::EXPECTED);
+        return repr_.value_;
+    }
+
+    template <typename U = T, std::enable_if_t<!std::is_void_v<U>, int> = 0>
+    const type& value() const & noexcept(!error_policy_throws())
+    {
+        enforce(Contains::EXPECTED);
+        return repr_.value_;
+    }
+
+    E& error() noexcept(!error_policy_throws())
+    {
+        enforce(Contains::UNEXPECTED);
+        return repr_.error_;
+    }
+
+    const E& error() const noexcept(!error_policy_throws())
+    {
+        enforce(Contains::UNEXPECTED);
+        return repr_.error_;
+    }
+
+private:
+    Contains contains() const noexcept
+    {
+        return repr_.template contains<Contains>();
+    }
+
+    static constexpr bool error_policy_throws() noexcept {
+        return std::is_same_v<EPOLICY, error_policy_throw>;
+    }
+
+    void enforce(const Contains kind) const noexcept(!error_policy_throws())
+    {
+        if constexpr (error_policy_throws()) {
+            if (contains() != kind) {
+                throw std::logic_error("invalid access");
+            }
+        } else {
+            assert(contains() == kind);
+        }
+    }
+
+    repr_type repr_;
+};
+
+namespace detail {
+
+// The value PTL_TRY evaluates to, nothing for expected<void, E>
+template <typename EXPECTED>
+PTL_FORCE_INLINE decltype(auto) expected_try_value(EXPECTED& e)
+{
+    if constexpr (std::is_void_v<typename expected_traits<std::remove_const_t<EXPECTED>>::value_type>) {
+        e.value();
+    } else if constexpr (std::is_const_v<EXPECTED> || std::is_reference_v<typename expected_traits<std::remove_const_t<EXPECTED>>::value_type>) {
+        return e.value();
+    } else {
+        return std::move(e.value());
+    }
+}
+
+} // namespace detail
+
 #if 0
 // This is the most optimal form, we store the enum and the 16-bit error_code in unused bits in the
 // pointer.  So it can simultaneously hold all information in a single 64-bit register
@@ -585,4 +1059,23 @@ private:
 };
 #endif
 
-} // namespace ptl
\ No newline at end of file
+} // namespace ptl
+/* Early return for functions returning an expected: evaluates to the moved value of the expression,
+ * or returns its error from the enclosing function.
+ *
+ *   ptl::expected<address, std::error_code> local() noexcept
+ *   {
+ *       auto sa = PTL_TRY(query_sockname());
+ *       return address(sa);
+ *   }
+ *
+ * A GNU statement expression, so not usable in coroutines (co_return) or in constant expressions.
+ */
+#define PTL_TRY(...)                                                 \
+    ({                                                               \
+        auto&& ptl_try_result_ = (__VA_ARGS__);                      \
+        if (ptl_try_result_.is_error()) {                            \
+            return std::move(ptl_try_result_.error());               \
+        }                                                            \
+        ::ptl::detail::expected_try_value(ptl_try_result_);          \
+    })
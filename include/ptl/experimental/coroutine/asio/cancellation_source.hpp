@@ -0,0 +1,72 @@
+#pragma once
+
+#include "ptl/intrusive_ptr.hpp"
+#include "cancellation_state.hpp"
+
+namespace ptl::experimental::coroutine::asio {
+
+// Observes a cancellation_source, a default constructed token is never cancelled
+class cancellation_token
+{
+public:
+    cancellation_token() noexcept = default;
+
+    bool can_be_cancelled() const noexcept
+    {
+        return static_cast<bool>(state_);
+    }
+
+    bool is_cancellation_requested() const noexcept
+    {
+        return state_ && state_->is_cancellation_requested();
+    }
+
+private:
+    friend class cancellation_source;
+
+    explicit cancellation_token(const ptl::intrusive_ptr<detail::cancellation_state>& state) noexcept
+        : state_(state)
+    {}
+
+    ptl::intrusive_ptr<detail::cancellation_state> state_;
+};
+
+// Requests cancellation of the operations holding one of its tokens.  Copies share the same state.
+class cancellation_source
+{
+public:
+    cancellation_source()
+        : state_(new detail::cancellation_state())
+    {}
+
+    // a source that cannot request anything, used where cancellation is optional
+    explicit cancellation_source(std::nullptr_t) noexcept
+    {}
+
+    cancellation_token token() const noexcept
+    {
+        return cancellation_token{ state_ };
+    }
+
+    bool can_be_cancelled() const noexcept
+    {
+        return static_cast<bool>(state_);
+    }
+
+    bool is_cancellation_requested() const noexcept
+    {
+        return state_ && state_->is_cancellation_requested();
+    }
+
+    void request_cancellation() noexcept
+    {
+        if (state_) {
+            state_->request_cancellation();
+        }
+    }
+
+private:
+    ptl::intrusive_ptr<detail::cancellation_state> state_;
+};
+
+}
@@ -1,17 +1,52 @@
 #pragma once
 
-#include <cstdlib>
+#include <atomic>
+#include <cstdint>
 
 namespace ptl::experimental::coroutine::asio {
 
 namespace detail {
 
-struct cancellation_registration_list_item
+// Shared between a cancellation_source and its tokens, freed with the last reference
+class cancellation_state
 {
-    static std::
+public:
+    cancellation_state() noexcept
+        : references_(1)
+        , requested_(false)
+    {}
 
+    cancellation_state(const cancellation_state&) = delete;
+    cancellation_state& operator=(const cancellation_state&) = delete;
+
+    void intrusive_ptr_add_ref() noexcept
+    {
+        references_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void intrusive_ptr_release() noexcept
+    {
+        if (references_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            delete this;
+        }
+    }
+
+    bool is_cancellation_requested() const noexcept
+    {
+        return requested_.load(std::memory_order_acquire);
+    }
+
+    // true for the first request only
+    bool request_cancellation() noexcept
+    {
+        return !requested_.exchange(true, std::memory_order_acq_rel);
+    }
+
+private:
+    std::atomic<uint32_t> references_;
+    std::atomic<bool> requested_;
 };
 
 }
 
-}
\ No newline at end of file
+}
@@ -34,6 +34,7 @@ private:
             socket_.start_io(iosvc::io_kind::read, this);
             return false;
         }
+        transferred_ = received_;
         return true;
     }
 
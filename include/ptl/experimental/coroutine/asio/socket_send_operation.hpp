@@ -28,7 +28,10 @@ private:
                 return false;
             }
             ec_= ptl::error_code{ errno };
+            return true;
         }
+        sent_ = r;
+        transferred_ = sent_;
         return true;
     }
 
@@ -0,0 +1,361 @@
+#pragma once
+
+#if !defined(__clang__)
+#error Unsupported compiler
+#endif
+#include <experimental/coroutine>
+#include <exception>
+#include <iterator>
+#include <type_traits>
+
+#include "awaitable_traits.hpp"
+
+namespace ptl::experimental::coroutine {
+
+template <typename T>
+class async_generator;
+
+namespace detail {
+
+template <typename T>
+class async_generator_iterator;
+class async_generator_yield_operation;
+class async_generator_advance_operation;
+
+// The yielded value is never copied: the promise only records the address of the value, which
+// lives in the producer's frame (or is a temporary of the co_yield expression) until the consumer
+// asks for the next element.
+class async_generator_promise_base
+{
+public:
+    async_generator_promise_base() noexcept
+        : current_value_(nullptr)
+    {}
+
+    async_generator_promise_base(const async_generator_promise_base&) = delete;
+    async_generator_promise_base& operator=(const async_generator_promise_base&) = delete;
+
+    std::experimental::suspend_always initial_suspend() const noexcept
+    {
+        return {};
+    }
+
+    async_generator_yield_operation final_suspend() noexcept;
+
+    void unhandled_exception() noexcept
+    {
+        exception_ = std::current_exception();
+    }
+
+    void return_void() noexcept
+    {}
+
+    bool finished() const noexcept
+    {
+        return current_value_ == nullptr;
+    }
+
+    void rethrow_if_exception()
+    {
+        if (exception_) {
+            std::rethrow_exception(exception_);
+        }
+    }
+
+protected:
+    async_generator_yield_operation internal_yield_value() noexcept;
+
+    const void* current_value_;
+
+private:
+    friend class async_generator_yield_operation;
+    friend class async_generator_advance_operation;
+
+    std::exception_ptr exception_;
+    std::experimental::coroutine_handle<> consumer_coroutine_;
+};
+
+// Suspends the producer and transfers straight back to the consumer
+class async_generator_yield_operation final
+{
+public:
+    explicit async_generator_yield_operation(std::experimental::coroutine_handle<> consumer) noexcept
+        : consumer_(consumer)
+    {}
+
+    bool await_ready() const noexcept
+    {
+        return false;
+    }
+
+    std::experimental::coroutine_handle<> await_suspend(std::experimental::coroutine_handle<>) noexcept
+    {
+        return consumer_;
+    }
+
+    void await_resume() noexcept
+    {}
+
+private:
+    std::experimental::coroutine_handle<> consumer_;
+};
+
+inline async_generator_yield_operation async_generator_promise_base::final_suspend() noexcept
+{
+    current_value_ = nullptr;
+    return internal_yield_value();
+}
+
+inline async_generator_yield_operation async_generator_promise_base::internal_yield_value() noexcept
+{
+    return async_generator_yield_operation{consumer_coroutine_};
+}
+
+// Suspends the consumer and transfers straight to the producer
+class async_generator_advance_operation
+{
+protected:
+    explicit async_generator_advance_operation(std::nullptr_t) noexcept
+        : promise_(nullptr)
+        , producer_(nullptr)
+    {}
+
+    async_generator_advance_operation(async_generator_promise_base& promise,
+                                      std::experimental::coroutine_handle<> producer) noexcept
+        : promise_(std::addressof(promise))
+        , producer_(producer)
+    {}
+
+public:
+    bool await_ready() const noexcept
+    {
+        return promise_ == nullptr;
+    }
+
+    std::experimental::coroutine_handle<> await_suspend(std::experimental::coroutine_handle<> consumer) noexcept
+    {
+        promise_->consumer_coroutine_ = consumer;
+        return producer_;
+    }
+
+protected:
+    async_generator_promise_base* promise_;
+    std::experimental::coroutine_handle<> producer_;
+};
+
+template <typename T>
+class async_generator_promise final : public async_generator_promise_base
+{
+    using value_type = std::remove_reference_t<T>;
+
+public:
+    async_generator_promise() noexcept = default;
+
+    async_generator<T> get_return_object() noexcept;
+
+    async_generator_yield_operation yield_value(value_type& value) noexcept
+    {
+        current_value_ = std::addressof(value);
+        return internal_yield_value();
+    }
+
+    async_generator_yield_operation yield_value(value_type&& value) noexcept
+    {
+        return yield_value(value);
+    }
+
+    value_type& value() const noexcept
+    {
+        return *static_cast<value_type*>(const_cast<void*>(current_value_));
+    }
+};
+
+template <typename T>
+class async_generator_increment_operation final : public async_generator_advance_operation
+{
+public:
+    explicit async_generator_increment_operation(async_generator_iterator<T>& iterator) noexcept
+        : async_generator_advance_operation(iterator.coroutine_.promise(), iterator.coroutine_)
+        , iterator_(iterator)
+    {}
+
+    async_generator_iterator<T>& await_resume();
+
+private:
+    async_generator_iterator<T>& iterator_;
+};
+
+template <typename T>
+class async_generator_iterator final
+{
+    using promise_type = async_generator_promise<T>;
+    using coroutine_handle_t = std::experimental::coroutine_handle<promise_type>;
+
+public:
+    using iterator_category = std::input_iterator_tag;
+    using difference_type = std::ptrdiff_t;
+    using value_type = std::remove_reference_t<T>;
+    using reference = std::add_lvalue_reference_t<T>;
+    using pointer = std::add_pointer_t<value_type>;
+
+    explicit async_generator_iterator(std::nullptr_t) noexcept
+        : coroutine_(nullptr)
+    {}
+
+    explicit async_generator_iterator(coroutine_handle_t coroutine) noexcept
+        : coroutine_(coroutine)
+    {}
+
+    // Must be co_await'ed, resumes the producer until it yields the next element or finishes
+    async_generator_increment_operation<T> operator++() noexcept
+    {
+        return async_generator_increment_operation<T>{*this};
+    }
+
+    reference operator*() const noexcept
+    {
+        return coroutine_.promise().value();
+    }
+
+    pointer operator->() const noexcept
+    {
+        return std::addressof(operator*());
+    }
+
+    bool operator==(const async_generator_iterator& other) const noexcept
+    {
+        return coroutine_ == other.coroutine_;
+    }
+
+    bool operator!=(const async_generator_iterator& other) const noexcept
+    {
+        return !(*this == other);
+    }
+
+private:
+    friend class async_generator_increment_operation<T>;
+
+    coroutine_handle_t coroutine_;
+};
+
+template <typename T>
+async_generator_iterator<T>& async_generator_increment_operation<T>::await_resume()
+{
+    if (promise_->finished()) {
+        // reaching the end, invalidate the iterator before surfacing any exception
+        iterator_ = async_generator_iterator<T>{nullptr};
+        promise_->rethrow_if_exception();
+    }
+    return iterator_;
+}
+
+template <typename T>
+class async_generator_begin_operation final : public async_generator_advance_operation
+{
+    using promise_type = async_generator_promise<T>;
+    using coroutine_handle_t = std::experimental::coroutine_handle<promise_type>;
+
+public:
+    explicit async_generator_begin_operation(std::nullptr_t) noexcept
+        : async_generator_advance_operation(nullptr)
+    {}
+
+    explicit async_generator_begin_operation(coroutine_handle_t producer) noexcept
+        : async_generator_advance_operation(producer.promise(), producer)
+    {}
+
+    async_generator_iterator<T> await_resume()
+    {
+        if (promise_ == nullptr) {
+            return async_generator_iterator<T>{nullptr};
+        }
+        if (promise_->finished()) {
+            promise_->rethrow_if_exception();
+            return async_generator_iterator<T>{nullptr};
+        }
+        return async_generator_iterator<T>{coroutine_handle_t::from_promise(*static_cast<promise_type*>(promise_))};
+    }
+};
+
+} // namespace detail
+
+/* async_generator<T> is a lazily started coroutine that can co_await and co_yield a sequence of
+ * values.  Consumption is also asynchronous:
+ *
+ *   for (auto it = co_await gen.begin(); it != gen.end(); co_await ++it) {
+ *       use(*it);
+ *   }
+ *
+ * Control passes between producer and consumer by symmetric transfer, and no element is ever
+ * copied or allocated.  The generator is single consumer and must be driven by one coroutine.
+ */
+template <typename T>
+class [[nodiscard]] async_generator
+{
+public:
+    using promise_type = detail::async_generator_promise<T>;
+    using iterator = detail::async_generator_iterator<T>;
+    using value_type = typename iterator::value_type;
+
+    async_generator() noexcept
+        : coroutine_(nullptr)
+    {}
+
+    explicit async_generator(promise_type& promise) noexcept
+        : coroutine_(std::experimental::coroutine_handle<promise_type>::from_promise(promise))
+    {}
+
+    async_generator(async_generator&& other) noexcept
+        : coroutine_(std::exchange(other.coroutine_, nullptr))
+    {}
+
+    async_generator(const async_generator&) = delete;
+    async_generator& operator=(const async_generator&) = delete;
+
+    ~async_generator()
+    {
+        if (coroutine_) {
+            coroutine_.destroy();
+        }
+    }
+
+    async_generator& operator=(async_generator&& other) noexcept
+    {
+        async_generator(std::move(other)).swap(*this);
+        return *this;
+    }
+
+    void swap(async_generator& other) noexcept
+    {
+        std::swap(coroutine_, other.coroutine_);
+    }
+
+    // Must be co_await'ed, starts the producer and runs it until the first element
+    auto begin() noexcept
+    {
+        if (!coroutine_) {
+            return detail::async_generator_begin_operation<T>{nullptr};
+        }
+        return detail::async_generator_begin_operation<T>{coroutine_};
+    }
+
+    auto end() noexcept
+    {
+        return iterator{nullptr};
+    }
+
+private:
+    std::experimental::coroutine_handle<promise_type> coroutine_;
+};
+
+namespace detail {
+
+template <typename T>
+async_generator<T> async_generator_promise<T>::get_return_object() noexcept
+{
+    return async_generator<T>{*this};
+}
+
+} // namespace detail
+
+} // namespace ptl::experimental::coroutine
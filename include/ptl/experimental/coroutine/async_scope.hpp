@@ -1,44 +1,55 @@
+#pragma once
+
 #if !defined(__clang__)
 #error Unsupported compiler
 #endif
 #include <experimental/coroutine>
 #include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <utility>
+#include <vector>
 
-#include "ptl/scope_guard.hpp"
+#include "ptl/pool_allocator.hpp"
+#include "detail/async_waiter.hpp"
 
 namespace ptl::experimental::coroutine {
 
-class async_scope
+struct async_scope_stats
 {
-public:
-    async_scope() noexcept
-        : count_(1u)
-    {}
+    size_t spawned;
+    size_t running;
+    size_t peak;
+    size_t failed;
+};
 
-    ~async_scope()
-    {
-        assert(continuation_);
-    }
+namespace detail {
 
-    template <typename AWAITABLE>
-    void spawn(AWAITABLE&& awaitable)
-    {
-        [](async_scope* scope, std::decay_t<AWAITABLE> awaitable) -> oneway_task {
-            scope->on_work_started();
-            SCOPE_EXIT({ scope->on_work_finished(); });
+/* Tracks fire-and-forget work.  Work spawned into the scope, including work spawned by that work,
+ * is tracked until it completes and join() resumes once everything has; the scope must be joined
+ * before it is destroyed.  Exceptions escaping spawned work are collected for take_exceptions().
+ */
+class async_scope_base
+{
+public:
+    async_scope_base(const async_scope_base&) = delete;
+    async_scope_base& operator=(const async_scope_base&) = delete;
 
-            co_await std::move(awaitable);
-        }(this, std::forward<AWAITABLE>(awaitable));
+    ~async_scope_base()
+    {
+        assert(count_.load(std::memory_order_relaxed) == 0);
     }
 
     [[nodiscard]] auto join() noexcept
     {
         class awaiter
         {
-            async_scope* scope_;
+            async_scope_base* scope_;
 
         public:
-            awaiter(async_scope* scope) noexcept
+            awaiter(async_scope_base* scope) noexcept
                 : scope_(scope)
             {}
 
@@ -60,47 +71,235 @@ public:
         return awaiter{this};
     }
 
-private:
-    std::atomic<size_t> count_;
-    std::experimental::coroutine_handle<> continuation_;
+    async_scope_stats stats() const noexcept
+    {
+        return {
+            spawned_.load(std::memory_order_relaxed),
+            running_.load(std::memory_order_relaxed),
+            peak_.load(std::memory_order_relaxed),
+            failed_.load(std::memory_order_relaxed),
+        };
+    }
+
+    // The exceptions that escaped spawned work so far, in completion order
+    std::vector<std::exception_ptr> take_exceptions()
+    {
+        std::scoped_lock lock(exceptions_lock_);
+        return std::exchange(exceptions_, {});
+    }
+
+protected:
+    // slots is the number of work items allowed in flight, 0 for no limit
+    explicit async_scope_base(std::ptrdiff_t slots) noexcept
+        : count_(1u)
+        , limited_(slots != 0)
+        , slots_(slots, slots)
+        , spawned_(0)
+        , running_(0)
+        , peak_(0)
+        , failed_(0)
+    {}
 
     struct oneway_task
     {
         struct promise_type
         {
-            std::experimental::suspend_never initial_suspend()
+            // Frames come from the per-thread size class pool, like Task's
+            static void* operator new(size_t sz)
             {
-                return {};
+                return pool_allocate(sz);
+            }
+
+            static void operator delete(void* ptr, size_t sz) noexcept
+            {
+                pool_deallocate(ptr, sz);
             }
-            std::experimental::suspend_never final_suspend()
+
+            std::experimental::suspend_always initial_suspend() noexcept
             {
                 return {};
             }
-            void unhandled_exception()
+
+            // The frame is freed before the scope hears about it: once the last
+            // piece of work finishes, the joined scope may be destroyed.
+            auto final_suspend() noexcept
             {
-                std::terminate();
+                struct awaitable
+                {
+                    bool await_ready() const noexcept
+                    {
+                        return false;
+                    }
+
+                    void await_suspend(std::experimental::coroutine_handle<promise_type> coroutine) noexcept
+                    {
+                        auto scope = coroutine.promise().scope_;
+                        coroutine.destroy();
+                        scope->on_work_finished();
+                    }
+
+                    void await_resume() noexcept
+                    {}
+                };
+                return awaitable{};
             }
-            oneway_task get_return_object()
+
+            void unhandled_exception() noexcept
             {
-                return {};
+                scope_->on_work_failed(std::current_exception());
             }
-            void return_void()
+
+            oneway_task get_return_object() noexcept
+            {
+                return oneway_task{std::experimental::coroutine_handle<promise_type>::from_promise(*this)};
+            }
+
+            void return_void() noexcept
             {}
+
+            async_scope_base* scope_ = nullptr;
         };
+
+        std::experimental::coroutine_handle<promise_type> coroutine_;
     };
 
+    template <typename AWAITABLE>
+    static oneway_task run(async_scope_base&, AWAITABLE awaitable)
+    {
+        co_await std::move(awaitable);
+    }
+
+    template <typename AWAITABLE>
+    void start(AWAITABLE&& awaitable)
+    {
+        on_work_started();
+        auto task = run(*this, std::move(awaitable));
+        task.coroutine_.promise().scope_ = this;
+        task.coroutine_.resume();
+    }
+
+    void on_work_started() noexcept
+    {
+        assert(count_.load(std::memory_order_relaxed) != 0);
+        count_.fetch_add(1, std::memory_order_relaxed);
+        spawned_.fetch_add(1, std::memory_order_relaxed);
+
+        auto running = running_.fetch_add(1, std::memory_order_relaxed) + 1;
+        auto peak = peak_.load(std::memory_order_relaxed);
+        while (peak < running && !peak_.compare_exchange_weak(peak, running, std::memory_order_relaxed)) {
+        }
+    }
+
+    void on_work_failed(std::exception_ptr e) noexcept
+    {
+        failed_.fetch_add(1, std::memory_order_relaxed);
+        std::scoped_lock lock(exceptions_lock_);
+        exceptions_.push_back(std::move(e));
+    }
+
     void on_work_finished() noexcept
     {
+        running_.fetch_sub(1, std::memory_order_relaxed);
+        if (limited_) {
+            slots_.release(1);
+        }
         if (count_.fetch_sub(1u, std::memory_order_acq_rel) == 1) {
             continuation_.resume();
         }
     }
 
-    void on_work_started() noexcept
+    std::atomic<size_t> count_;
+    std::experimental::coroutine_handle<> continuation_;
+
+    const bool limited_;
+    async_semaphore_core slots_;
+
+    std::atomic<size_t> spawned_;
+    std::atomic<size_t> running_;
+    std::atomic<size_t> peak_;
+    std::atomic<size_t> failed_;
+
+    std::mutex exceptions_lock_;
+    std::vector<std::exception_ptr> exceptions_;
+};
+
+} // namespace detail
+
+// Scope without a limit, spawn() starts the work at once
+class async_scope : public detail::async_scope_base
+{
+public:
+    async_scope() noexcept
+        : async_scope_base(0)
+    {}
+
+    template <typename AWAITABLE>
+    void spawn(AWAITABLE&& awaitable)
     {
-        assert(count_.load(std::memory_order_relaxed) != 0);
-        count_.fetch_add(1, std::memory_order_relaxed);
+        start(std::decay_t<AWAITABLE>(std::forward<AWAITABLE>(awaitable)));
+    }
+};
+
+/* Scope that keeps at most max_in_flight pieces of work running: co_await spawn() suspends until a
+ * slot is free, try_spawn() fails instead.  Work that spawns more work into the scope should use
+ * try_spawn(): awaiting a slot that only its own ancestors can free never resumes.
+ */
+class bounded_async_scope : public detail::async_scope_base
+{
+public:
+    explicit bounded_async_scope(size_t max_in_flight) noexcept
+        : async_scope_base(static_cast<std::ptrdiff_t>(max_in_flight))
+    {
+        assert(max_in_flight > 0);
+    }
+
+    // Must be co_await'ed, starts awaitable once a slot is free
+    template <typename AWAITABLE>
+    [[nodiscard]] auto spawn(AWAITABLE&& awaitable)
+    {
+        class awaiter
+        {
+        public:
+            awaiter(bounded_async_scope& scope, std::decay_t<AWAITABLE>&& awaitable)
+                : scope_(scope)
+                , awaitable_(std::move(awaitable))
+                , slot_(scope.slots_)
+            {}
+
+            bool await_ready() noexcept
+            {
+                return slot_.await_ready();
+            }
+
+            bool await_suspend(std::experimental::coroutine_handle<> coroutine) noexcept
+            {
+                return slot_.await_suspend(coroutine);
+            }
+
+            void await_resume()
+            {
+                scope_.start(std::move(awaitable_));
+            }
+
+        private:
+            bounded_async_scope& scope_;
+            std::decay_t<AWAITABLE> awaitable_;
+            detail::async_semaphore_awaiter slot_;
+        };
+
+        return awaiter{*this, std::decay_t<AWAITABLE>(std::forward<AWAITABLE>(awaitable))};
+    }
+
+    // Starts awaitable if a slot is free, false otherwise
+    template <typename AWAITABLE>
+    bool try_spawn(AWAITABLE&& awaitable)
+    {
+        if (!slots_.try_acquire()) {
+            return false;
+        }
+        start(std::decay_t<AWAITABLE>(std::forward<AWAITABLE>(awaitable)));
+        return true;
     }
 };
 
-} // namespace ptl::experimental::coroutine
\ No newline at end of file
+} // namespace ptl::experimental::coroutine
@@ -0,0 +1,206 @@
+#pragma once
+
+#if !defined(__clang__)
+#error Unsupported compiler
+#endif
+#include <experimental/coroutine>
+#include <atomic>
+#include <cstddef>
+#include <limits>
+#include <optional>
+#include <thread>
+
+#include "ptl/mpmc_queue.hpp"
+#include "detail/async_waiter.hpp"
+
+namespace ptl::experimental::coroutine {
+
+/* Bounded multi producer, multi consumer channel for coroutine pipelines.
+ *
+ *   co_await ch.send(v)   suspends while the channel is full, false once closed
+ *   co_await ch.recv()    suspends while the channel is empty, std::nullopt once closed and drained
+ *
+ * Elements live in the slots of a ptl::queue<T, Lockless::MPMC>, two semaphore cores count the
+ * free slots and the ready elements.  A permit guarantees a slot is being filled (or emptied), so
+ * the queue only ever spins on an operation already in progress.  Wakeups released while a dispatcher is running are delivered by it in one
+ * batch instead of one resume chain per element.
+ *
+ * close() wakes every waiter: pending and future sends fail, receivers drain what was sent.
+ */
+template<typename T>
+class channel
+{
+    static_assert(std::is_nothrow_default_constructible_v<T>);
+
+    // enough permits to satisfy every waiter that will ever come once closed
+    static constexpr std::ptrdiff_t closed_permits = std::numeric_limits<std::ptrdiff_t>::max() / 4;
+
+public:
+    explicit channel(size_t capacity)
+        : queue_(capacity)
+        , free_(static_cast<std::ptrdiff_t>(capacity), std::numeric_limits<std::ptrdiff_t>::max())
+        , ready_(0, std::numeric_limits<std::ptrdiff_t>::max())
+        , senders_(0)
+        , closed_(false)
+    {}
+
+    channel(const channel&) = delete;
+    channel& operator=(const channel&) = delete;
+
+    void close() noexcept
+    {
+        if (!closed_.exchange(true, std::memory_order_seq_cst)) {
+            free_.release(closed_permits);
+            ready_.release(closed_permits);
+        }
+    }
+
+    bool is_closed() const noexcept
+    {
+        return closed_.load(std::memory_order_acquire);
+    }
+
+    bool try_send(T value) noexcept
+    {
+        if (!begin_send()) {
+            return false;
+        }
+        if (!free_.try_acquire()) {
+            end_send();
+            return false;
+        }
+        return complete_send(value);
+    }
+
+    std::optional<T> try_recv() noexcept
+    {
+        if (!ready_.try_acquire()) {
+            return std::nullopt;
+        }
+        return complete_recv();
+    }
+
+    auto send(T value) noexcept
+    {
+        class awaiter : detail::async_waiter
+        {
+        public:
+            awaiter(channel& ch, T&& value) noexcept
+                : channel_(ch)
+                , value_(std::move(value))
+                , started_(false)
+            {}
+
+            bool await_ready() noexcept
+            {
+                started_ = channel_.begin_send();
+                return !started_ || channel_.free_.try_acquire();
+            }
+
+            bool await_suspend(std::experimental::coroutine_handle<> coroutine) noexcept
+            {
+                coroutine_ = coroutine;
+                return channel_.free_.enqueue(*this);
+            }
+
+            bool await_resume() noexcept
+            {
+                return started_ && channel_.complete_send(value_);
+            }
+
+        private:
+            channel& channel_;
+            T value_;
+            bool started_;
+        };
+        return awaiter{ *this, std::move(value) };
+    }
+
+    auto recv() noexcept
+    {
+        class awaiter : detail::async_waiter
+        {
+        public:
+            explicit awaiter(channel& ch) noexcept
+                : channel_(ch)
+            {}
+
+            bool await_ready() noexcept
+            {
+                return channel_.ready_.try_acquire();
+            }
+
+            bool await_suspend(std::experimental::coroutine_handle<> coroutine) noexcept
+            {
+                coroutine_ = coroutine;
+                return channel_.ready_.enqueue(*this);
+            }
+
+            std::optional<T> await_resume() noexcept
+            {
+                return channel_.complete_recv();
+            }
+
+        private:
+            channel& channel_;
+        };
+        return awaiter{ *this };
+    }
+
+private:
+    // senders_ counts sends that may still push, a closed channel without any is fully drained
+    bool begin_send() noexcept
+    {
+        senders_.fetch_add(1, std::memory_order_seq_cst);
+        if (closed_.load(std::memory_order_seq_cst)) {
+            end_send();
+            return false;
+        }
+        return true;
+    }
+
+    void end_send() noexcept
+    {
+        senders_.fetch_sub(1, std::memory_order_release);
+    }
+
+    // holds a free slot permit, which may be one of the permits released by close()
+    bool complete_send(T& value) noexcept
+    {
+        bool sent = false;
+        if (!closed_.load(std::memory_order_acquire)) {
+            queue_.push(std::move(value));
+            ready_.release(1);
+            sent = true;
+        }
+        end_send();
+        return sent;
+    }
+
+    // Holds a ready permit, which may be one of the permits released by close().  Receivers
+    // claim elements with try_pop only: elements complete out of ticket order, and after close a
+    // receiver must never wait on a ticket another receiver already emptied.
+    std::optional<T> complete_recv() noexcept
+    {
+        T value;
+        while (true) {
+            bool drained = closed_.load(std::memory_order_acquire) && senders_.load(std::memory_order_acquire) == 0;
+            if (queue_.try_pop(value)) {
+                free_.release(1);
+                return value;
+            }
+            if (drained) {
+                return std::nullopt;
+            }
+            std::this_thread::yield();
+        }
+    }
+
+    ptl::queue<T, Lockless::MPMC> queue_;
+    detail::async_semaphore_core free_;
+    detail::async_semaphore_core ready_;
+    std::atomic<size_t> senders_;
+    std::atomic<bool> closed_;
+};
+
+}
@@ -0,0 +1,202 @@
+#pragma once
+#include <experimental/coroutine>
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+
+namespace ptl::experimental::coroutine::detail {
+
+// Intrusive wait list node, lives in the awaiter and therefore in the suspended coroutine frame
+struct async_waiter
+{
+    async_waiter* next_ = nullptr;
+    std::experimental::coroutine_handle<> coroutine_;
+};
+
+// Reverses a LIFO chain of waiters pushed by a lock-free stack into FIFO order
+inline async_waiter* reverse_waiters(async_waiter* head) noexcept
+{
+    async_waiter* fifo = nullptr;
+    while (head) {
+        auto next = head->next_;
+        head->next_ = fifo;
+        fifo = head;
+        head = next;
+    }
+    return fifo;
+}
+
+/* Resumes a FIFO chain of waiters in order.  A resumed coroutine that wakes another one, e.g. by
+ * unlocking a mutex, calls back in here: the waiters are then appended to the queue of the outer
+ * call on the same thread instead of being resumed inline, so a long hand over chain runs in a
+ * loop and cannot overflow the stack.
+ */
+inline void resume_waiters(async_waiter* fifo) noexcept
+{
+    struct resume_queue
+    {
+        async_waiter* head = nullptr;
+        async_waiter* tail = nullptr;
+        bool running = false;
+    };
+    static thread_local resume_queue queue;
+
+    if (fifo == nullptr) {
+        return;
+    }
+    if (queue.tail != nullptr) {
+        queue.tail->next_ = fifo;
+    } else {
+        queue.head = fifo;
+    }
+    while (fifo->next_ != nullptr) {
+        fifo = fifo->next_;
+    }
+    queue.tail = fifo;
+    if (queue.running) {
+        return;
+    }
+
+    queue.running = true;
+    while (auto waiter = queue.head) {
+        queue.head = waiter->next_;
+        if (queue.head == nullptr) {
+            queue.tail = nullptr;
+        }
+        waiter->coroutine_.resume();
+    }
+    queue.running = false;
+}
+
+/* Counting core shared by async_semaphore and async_auto_reset_event.
+ *
+ * count_ is the number of available permits, or minus the number of waiters.  Waiters push
+ * themselves on a lock-free stack, releases that owe wakeups add them to pending_ and the one
+ * moving pending_ away from zero becomes the only dispatcher: it alone pops waiters (so there is
+ * no ABA) and keeps resuming until every owed wakeup is delivered, this also keeps a resumed
+ * coroutine that releases again from recursing.
+ */
+class async_semaphore_core
+{
+public:
+    async_semaphore_core(std::ptrdiff_t initial, std::ptrdiff_t max) noexcept
+        : count_(initial)
+        , max_(max)
+        , pending_(0)
+        , incoming_(nullptr)
+        , fifo_(nullptr)
+    {}
+
+    async_semaphore_core(const async_semaphore_core&) = delete;
+    async_semaphore_core& operator=(const async_semaphore_core&) = delete;
+
+    bool try_acquire() noexcept
+    {
+        auto count = count_.load(std::memory_order_relaxed);
+        while (count > 0) {
+            if (count_.compare_exchange_weak(count, count - 1, std::memory_order_acquire, std::memory_order_relaxed)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // false when a permit was taken and the waiter must not suspend
+    bool enqueue(async_waiter& waiter) noexcept
+    {
+        if (count_.fetch_sub(1, std::memory_order_acq_rel) > 0) {
+            return false;
+        }
+        auto head = incoming_.load(std::memory_order_relaxed);
+        do {
+            waiter.next_ = head;
+        } while (!incoming_.compare_exchange_weak(head, &waiter, std::memory_order_release, std::memory_order_relaxed));
+        return true;
+    }
+
+    void release(std::ptrdiff_t n) noexcept
+    {
+        auto count = count_.load(std::memory_order_relaxed);
+        std::ptrdiff_t wake;
+        std::ptrdiff_t next;
+        do {
+            next = std::min(count + n, std::max(count, max_));
+            if (next == count) {
+                return;
+            }
+            wake = count < 0 ? std::min(n, -count) : 0;
+        } while (!count_.compare_exchange_weak(count, next, std::memory_order_acq_rel, std::memory_order_relaxed));
+
+        if (wake > 0) {
+            dispatch(static_cast<size_t>(wake));
+        }
+    }
+
+    std::ptrdiff_t available() const noexcept
+    {
+        return std::max<std::ptrdiff_t>(count_.load(std::memory_order_relaxed), 0);
+    }
+
+private:
+    void dispatch(size_t wake) noexcept
+    {
+        if (pending_.fetch_add(wake, std::memory_order_acq_rel) != 0) {
+            return;
+        }
+        do {
+            for (size_t i = 0; i < wake; i++) {
+                pop()->coroutine_.resume();
+            }
+            wake = pending_.fetch_sub(wake, std::memory_order_acq_rel) - wake;
+        } while (wake != 0);
+    }
+
+    async_waiter* pop() noexcept
+    {
+        if (fifo_ == nullptr) {
+            // the waiter owed this wakeup has decremented count_ but may not be pushed yet
+            async_waiter* incoming;
+            while ((incoming = incoming_.exchange(nullptr, std::memory_order_acquire)) == nullptr) {
+                std::this_thread::yield();
+            }
+            fifo_ = reverse_waiters(incoming);
+        }
+        auto waiter = fifo_;
+        fifo_ = waiter->next_;
+        return waiter;
+    }
+
+    std::atomic<std::ptrdiff_t> count_;
+    const std::ptrdiff_t max_;
+    std::atomic<size_t> pending_;
+    std::atomic<async_waiter*> incoming_;
+    async_waiter* fifo_;    // owned by the dispatcher
+};
+
+class async_semaphore_awaiter : async_waiter
+{
+public:
+    explicit async_semaphore_awaiter(async_semaphore_core& core) noexcept
+        : core_(core)
+    {}
+
+    bool await_ready() noexcept
+    {
+        return core_.try_acquire();
+    }
+
+    bool await_suspend(std::experimental::coroutine_handle<> coroutine) noexcept
+    {
+        coroutine_ = coroutine;
+        return core_.enqueue(*this);
+    }
+
+    void await_resume() noexcept
+    {}
+
+private:
+    async_semaphore_core& core_;
+};
+
+}
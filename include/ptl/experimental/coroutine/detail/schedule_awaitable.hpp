@@ -9,6 +9,23 @@
 
 namespace ptl::experimental::coroutine::detail {
 
+// work_item that resumes a coroutine, embed it wherever the coroutine is suspended
+struct resume_work_item : execution::work_item
+{
+    resume_work_item() noexcept
+        : work_item(&resume)
+        , coroutine_(nullptr)
+    {}
+
+    std::experimental::coroutine_handle<> coroutine_;
+
+private:
+    static void resume(work_item* item) noexcept
+    {
+        static_cast<resume_work_item*>(item)->coroutine_.resume();
+    }
+};
+
 struct SchedulerAwaitable
 {
     SchedulerAwaitable(ptl::execution::Executor* ex)
@@ -25,8 +42,8 @@ struct SchedulerAwaitable
 
     void await_suspend(std::experimental::coroutine_handle<> coroutine) noexcept
     {
-        //auto& promise
-        executor_->add([coroutine = coroutine]() mutable { coroutine.resume(); });
+        item_.coroutine_ = coroutine;
+        executor_->post(item_);
     }
 
     void await_resume()
@@ -34,6 +51,7 @@ struct SchedulerAwaitable
 
 private:
     execution::Executor* executor_;
+    resume_work_item item_;
 };
 
 
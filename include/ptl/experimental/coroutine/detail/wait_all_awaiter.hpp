@@ -1,7 +1,9 @@
 #pragma once
 #include <experimental/coroutine>
 #include "is_awaiter.hpp"
+#include "ptl/execution/basic_executor.hpp"
 #include <tuple>
+#include <vector>
 
 namespace ptl::experimental::coroutine::detail {
 
@@ -99,4 +101,83 @@ private:
     wait_all_counter counter_;
 };
 
-}
\ No newline at end of file
+// Awaits a runtime sized set of tasks.  All tasks share one counter, the wrappers live in one
+// vector and the results are moved into a vector reserved up front, in the order of the input.
+template<typename TASK>
+class wait_all_range_awaitable {
+    using result_type = decltype(std::declval<TASK&&>().result());
+    using value_type = std::decay_t<result_type>;
+    using container_type = std::conditional_t<std::is_void_v<result_type>, void, std::vector<value_type>>;
+
+public:
+    explicit wait_all_range_awaitable(std::vector<TASK>&& tasks, execution::Executor* ex = nullptr) noexcept
+        : tasks_(std::move(tasks))
+        , counter_(tasks_.size())
+        , executor_(ex)
+    {}
+
+    wait_all_range_awaitable(wait_all_range_awaitable&& other) noexcept
+        : tasks_(std::move(other.tasks_))
+        , counter_(tasks_.size())
+        , executor_(other.executor_)
+    {}
+
+    auto operator co_await() noexcept
+    {
+        struct awaiter {
+            bool await_ready() const noexcept
+            {
+                return awaitable_.tasks_.empty();
+            }
+            bool await_suspend(std::experimental::coroutine_handle<> coroutine) noexcept
+            {
+                return awaitable_.begin_await(coroutine);
+            }
+            container_type await_resume()
+            {
+                return awaitable_.results();
+            }
+
+            wait_all_range_awaitable& awaitable_;
+        };
+        return awaiter{ *this };
+    }
+
+private:
+    bool begin_await(std::experimental::coroutine_handle<> coroutine) noexcept
+    {
+        if (executor_) {
+            for (auto& task : tasks_) {
+                task.start(counter_, executor_);
+            }
+        } else {
+            for (auto& task : tasks_) {
+                task.start(counter_);
+            }
+        }
+        return counter_.begin_await(coroutine);
+    }
+
+    // the first failed task, in input order, rethrows its exception
+    container_type results()
+    {
+        if constexpr (std::is_void_v<result_type>) {
+            for (auto& task : tasks_) {
+                task.result();
+            }
+        } else {
+            std::vector<value_type> values;
+            values.reserve(tasks_.size());
+            for (auto& task : tasks_) {
+                values.emplace_back(std::move(task).result());
+            }
+            return values;
+        }
+    }
+
+    std::vector<TASK> tasks_;
+    wait_all_counter counter_;
+    execution::Executor* executor_;
+};
+
+}
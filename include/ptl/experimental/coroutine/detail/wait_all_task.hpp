@@ -1,5 +1,6 @@
 #pragma once
 #include "wait_all_counter.hpp"
+#include "schedule_awaitable.hpp"
 
 namespace ptl::experimental::coroutine::detail {
 
@@ -48,9 +49,24 @@ public:
         }
     }
 
+    void start(wait_all_counter& counter) noexcept
+    {
+        counter_ = &counter;
+        coroutine_handle::from_promise(*static_cast<DERIVED*>(this)).resume();
+    }
+
+    // Start on ex instead of inline, through the work item embedded in the promise
+    void start(wait_all_counter& counter, execution::Executor* ex) noexcept
+    {
+        counter_ = &counter;
+        hop_.coroutine_ = coroutine_handle::from_promise(*static_cast<DERIVED*>(this));
+        ex->post(hop_);
+    }
+
 protected:
     wait_all_counter* counter_;
     std::exception_ptr exception_;
+    resume_work_item hop_;
 };
 
 template<typename RESULT>
@@ -78,12 +94,6 @@ public:
         return this->final_suspend();
     }
 
-    void start(wait_all_counter& counter) noexcept
-    {
-        this->counter_ = &counter;
-        coroutine_handle::from_promise(*this).resume();
-    }
-
     RESULT& result() &
     {
         this->rethrow_exception();
@@ -116,12 +126,6 @@ public:
     {
     }
 
-    void start(wait_all_counter& counter) noexcept
-    {
-        this->counter_ = &counter;
-        coroutine_handle::from_promise(*this).resume();
-    }
-
     void result()
     {
         this->rethrow_exception();
@@ -161,7 +165,7 @@ public:
     }
     decltype(auto) non_void_result() &
     {
-        if constexpr(std::is_void_v<decltype(this->resuult())>)
+        if constexpr(std::is_void_v<decltype(this->result())>)
         {
             this->result();
             return void_value{};
@@ -173,7 +177,7 @@ public:
     }
     decltype(auto) non_void_result() &&
     {
-        if constexpr(std::is_void_v<decltype(this->resuult())>)
+        if constexpr(std::is_void_v<decltype(this->result())>)
         {
             std::move(*this).result();
             return void_value{};
@@ -187,12 +191,19 @@ public:
 private:
     template<typename T>
     friend class wait_all_awaitable;
+    template<typename T>
+    friend class wait_all_range_awaitable;
 
     void start(wait_all_counter& counter) noexcept
     {
         coroutine_.promise().start(counter);
     }
 
+    void start(wait_all_counter& counter, execution::Executor* ex) noexcept
+    {
+        coroutine_.promise().start(counter, ex);
+    }
+
     coroutine_handle coroutine_;
 };
 
@@ -0,0 +1,53 @@
+#pragma once
+#include <experimental/coroutine>
+#include <cassert>
+#include <memory>
+#include <utility>
+#include "wait_any_task.hpp"
+
+namespace ptl::experimental::coroutine::detail {
+
+template<typename RESULT>
+class wait_any_awaitable {
+    using race_type = wait_any_race<RESULT>;
+    using container_type = std::conditional_t<std::is_void_v<RESULT>, size_t, std::pair<size_t, RESULT>>;
+
+public:
+    wait_any_awaitable(std::vector<wait_any_task<RESULT>>&& tasks, asio::cancellation_source source)
+        : race_(std::make_unique<race_type>(std::move(tasks), std::move(source)))
+    {
+        assert(race_->size() > 0);
+    }
+
+    auto operator co_await() noexcept
+    {
+        struct awaiter {
+            bool await_ready() const noexcept
+            {
+                return false;
+            }
+            bool await_suspend(std::experimental::coroutine_handle<> coroutine) noexcept
+            {
+                return awaitable_.race_->begin_await(coroutine);
+            }
+            container_type await_resume()
+            {
+                auto& race = *awaitable_.race_;
+                if constexpr (std::is_void_v<RESULT>) {
+                    race.result();
+                    return race.winner();
+                } else {
+                    return container_type{ race.winner(), race.result() };
+                }
+            }
+
+            wait_any_awaitable& awaitable_;
+        };
+        return awaiter{ *this };
+    }
+
+private:
+    std::unique_ptr<race_type> race_;
+};
+
+}
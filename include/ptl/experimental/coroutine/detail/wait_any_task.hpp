@@ -0,0 +1,229 @@
+#pragma once
+#include <experimental/coroutine>
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <limits>
+#include <vector>
+
+#include "ptl/expected.hpp"
+#include "ptl/experimental/coroutine/asio/cancellation_source.hpp"
+
+namespace ptl::experimental::coroutine::detail {
+
+template<typename RESULT>
+class wait_any_task;
+
+template<typename RESULT>
+class wait_any_race;
+
+template<typename RESULT, typename DERIVED>
+class wait_any_promise_base
+{
+public:
+    using coroutine_handle = std::experimental::coroutine_handle<DERIVED>;
+
+    wait_any_promise_base() noexcept
+        : race_(nullptr)
+        , index_(0)
+    {}
+
+    auto get_return_object() noexcept
+    {
+        return coroutine_handle::from_promise(static_cast<DERIVED&>(*this));
+    }
+
+    std::experimental::suspend_always initial_suspend() noexcept
+    {
+        return {};
+    }
+
+    auto final_suspend() noexcept
+    {
+        struct completion_awaitable {
+            bool await_ready() const noexcept { return false; }
+            std::experimental::coroutine_handle<> await_suspend(coroutine_handle coroutine) const noexcept
+            {
+                auto& promise = coroutine.promise();
+                return promise.race_->complete(promise.index_);
+            }
+            void await_resume() const noexcept {}
+        };
+
+        return completion_awaitable{};
+    }
+
+    void unhandled_exception() noexcept
+    {
+        value_ = storage(std::current_exception());
+    }
+
+    void start(wait_any_race<RESULT>& race, size_t index) noexcept
+    {
+        race_ = &race;
+        index_ = index;
+        coroutine_handle::from_promise(static_cast<DERIVED&>(*this)).resume();
+    }
+
+    decltype(auto) result()
+    {
+        if constexpr (std::is_void_v<RESULT>) {
+            value_.value();
+        } else {
+            return std::move(value_).value();
+        }
+    }
+
+protected:
+    using storage = ptl::expected<RESULT, std::exception_ptr, ptl::error_policy_throw>;
+    storage value_;
+
+private:
+    wait_any_race<RESULT>* race_;
+    size_t index_;
+};
+
+template<typename RESULT>
+class wait_any_promise final : public wait_any_promise_base<RESULT, wait_any_promise<RESULT>>
+{
+    using super = wait_any_promise_base<RESULT, wait_any_promise<RESULT>>;
+
+public:
+    template<typename VALUE_TYPE>
+    void return_value(VALUE_TYPE&& value)
+    {
+        this->value_ = typename super::storage(static_cast<RESULT>(std::forward<VALUE_TYPE>(value)));
+    }
+};
+
+// an empty expected<void> already means success
+template<>
+class wait_any_promise<void> final : public wait_any_promise_base<void, wait_any_promise<void>>
+{
+public:
+    void return_void() noexcept
+    {}
+};
+
+template<typename RESULT>
+class wait_any_task final
+{
+public:
+    using promise_type = wait_any_promise<RESULT>;
+    using coroutine_handle = std::experimental::coroutine_handle<promise_type>;
+
+    wait_any_task(coroutine_handle coroutine) noexcept
+        : coroutine_(coroutine)
+    {}
+    wait_any_task(wait_any_task&& other) noexcept
+        : coroutine_(std::exchange(other.coroutine_, coroutine_handle{}))
+    {}
+
+    ~wait_any_task()
+    {
+        if (coroutine_) {
+            coroutine_.destroy();
+        }
+    }
+    wait_any_task(const wait_any_task&) = delete;
+    wait_any_task& operator=(const wait_any_task&) = delete;
+
+    void start(wait_any_race<RESULT>& race, size_t index) noexcept
+    {
+        coroutine_.promise().start(race, index);
+    }
+
+    decltype(auto) result()
+    {
+        return coroutine_.promise().result();
+    }
+
+private:
+    coroutine_handle coroutine_;
+};
+
+/* The awaiting coroutine resumes once every started task has completed.  The winner requests
+ * cancellation so the losers can stop early, but whatever they use (sockets, buffers, awaitables
+ * held by reference) stays alive until they are done.
+ *
+ * pending_ counts the started tasks that have not completed plus one for the coroutine starting
+ * them, whoever brings it to zero resumes the awaiting coroutine, this covers tasks that complete
+ * while still being started.
+ */
+template<typename RESULT>
+class wait_any_race
+{
+    static constexpr size_t no_winner = std::numeric_limits<size_t>::max();
+
+public:
+    wait_any_race(std::vector<wait_any_task<RESULT>>&& tasks, asio::cancellation_source source) noexcept
+        : tasks_(std::move(tasks))
+        , source_(std::move(source))
+        , pending_(tasks_.size() + 1)
+        , winner_(no_winner)
+    {}
+
+    size_t size() const noexcept
+    {
+        return tasks_.size();
+    }
+
+    bool begin_await(std::experimental::coroutine_handle<> coroutine) noexcept
+    {
+        continuation_ = coroutine;
+        size_t started = 0;
+        // once the race is decided the remaining tasks are never started
+        while (started < tasks_.size() && winner_.load(std::memory_order_acquire) == no_winner) {
+            tasks_[started].start(*this, started);
+            started++;
+        }
+        auto done = tasks_.size() - started + 1;
+        return pending_.fetch_sub(done, std::memory_order_acq_rel) > done;
+    }
+
+    size_t winner() const noexcept
+    {
+        return winner_.load(std::memory_order_acquire);
+    }
+
+    decltype(auto) result()
+    {
+        return tasks_[winner()].result();
+    }
+
+private:
+    friend class wait_any_promise_base<RESULT, wait_any_promise<RESULT>>;
+
+    std::experimental::coroutine_handle<> complete(size_t index) noexcept
+    {
+        size_t expected = no_winner;
+        if (winner_.compare_exchange_strong(expected, index, std::memory_order_acq_rel)) {
+            source_.request_cancellation();
+        }
+        // the awaiting coroutine may free the race as soon as pending_ is zero
+        auto continuation = continuation_;
+        if (pending_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            return continuation;
+        }
+        return std::experimental::noop_coroutine();
+    }
+
+    std::vector<wait_any_task<RESULT>> tasks_;
+    asio::cancellation_source source_;
+    std::experimental::coroutine_handle<> continuation_;
+    std::atomic<size_t> pending_;
+    std::atomic<size_t> winner_;
+};
+
+template<typename RESULT, typename AWAITABLE>
+wait_any_task<RESULT> make_wait_any_task(AWAITABLE awaitable)
+{
+    if constexpr (std::is_void_v<RESULT>) {
+        co_await static_cast<AWAITABLE&&>(awaitable);
+        co_return;
+    } else {
+        co_return co_await static_cast<AWAITABLE&&>(awaitable);
+    }
+}
+
+}
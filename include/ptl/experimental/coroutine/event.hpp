@@ -1,17 +1,122 @@
 #pragma once
 
-namespace ptl::experimental::coroutine {
+#if !defined(__clang__)
+#error Unsupported compiler
+#endif
+#include <experimental/coroutine>
+#include <atomic>
 
-namespace detail {
+#include "detail/async_waiter.hpp"
 
-}
+namespace ptl::experimental::coroutine {
 
-class async_event {
+/* Coroutine counterpart of ptl::sync::manual_reset_event: co_await suspends until set() is called,
+ * once set every await completes immediately until reset().
+ *
+ * state_ is `this` when set, nullptr when not set and otherwise the head of the waiter stack.
+ */
+class async_manual_reset_event
+{
 public:
+    explicit async_manual_reset_event(bool initially_set = false) noexcept
+        : state_(initially_set ? static_cast<void*>(this) : nullptr)
+    {}
+
+    async_manual_reset_event(const async_manual_reset_event&) = delete;
+    async_manual_reset_event& operator=(const async_manual_reset_event&) = delete;
+
+    bool is_set() const noexcept
+    {
+        return state_.load(std::memory_order_acquire) == static_cast<const void*>(this);
+    }
+
+    // resumes every waiter in the order they started waiting, see resume_waiters()
+    void set() noexcept
+    {
+        void* old = state_.exchange(this, std::memory_order_acq_rel);
+        if (old != this) {
+            detail::resume_waiters(detail::reverse_waiters(static_cast<detail::async_waiter*>(old)));
+        }
+    }
+
+    void reset() noexcept
+    {
+        void* old = this;
+        state_.compare_exchange_strong(old, nullptr, std::memory_order_relaxed);
+    }
+
+    auto operator co_await() const noexcept
+    {
+        struct awaiter : detail::async_waiter
+        {
+            explicit awaiter(const async_manual_reset_event& event) noexcept
+                : event_(event)
+            {}
+
+            bool await_ready() const noexcept
+            {
+                return event_.is_set();
+            }
+
+            bool await_suspend(std::experimental::coroutine_handle<> coroutine) noexcept
+            {
+                coroutine_ = coroutine;
+                void* old = event_.state_.load(std::memory_order_acquire);
+                do {
+                    if (old == static_cast<const void*>(&event_)) {
+                        return false;
+                    }
+                    next_ = static_cast<detail::async_waiter*>(old);
+                } while (!event_.state_.compare_exchange_weak(old, static_cast<detail::async_waiter*>(this),
+                                                              std::memory_order_release, std::memory_order_acquire));
+                return true;
+            }
+
+            void await_resume() noexcept
+            {}
 
+        private:
+            const async_manual_reset_event& event_;
+        };
+        return awaiter{ *this };
+    }
 
 private:
     mutable std::atomic<void*> state_;
 };
 
-}
\ No newline at end of file
+/* Every set() releases exactly one waiter, when nobody is waiting the event stays set until the next
+ * co_await consumes it.  Setting an already set event has no effect.
+ */
+class async_auto_reset_event
+{
+public:
+    explicit async_auto_reset_event(bool initially_set = false) noexcept
+        : core_(initially_set ? 1 : 0, 1)
+    {}
+
+    bool is_set() const noexcept
+    {
+        return core_.available() > 0;
+    }
+
+    void set() noexcept
+    {
+        core_.release(1);
+    }
+
+    void reset() noexcept
+    {
+        core_.try_acquire();
+    }
+
+    auto operator co_await() noexcept
+    {
+        return detail::async_semaphore_awaiter{ core_ };
+    }
+
+private:
+    detail::async_semaphore_core core_;
+};
+
+}
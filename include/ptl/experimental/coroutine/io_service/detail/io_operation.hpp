@@ -5,6 +5,8 @@
 #include <system_error>
 #include <experimental/coroutine>
 #include "io_service_impl.hpp"
+#include "ptl/execution/cooperative_budget.hpp"
+#include "ptl/experimental/coroutine/yield.hpp"
 
 
 namespace ptl::experimental::coroutine::iosvc::detail {
@@ -17,6 +19,7 @@ struct io_operation
 {
 private:
     std::experimental::coroutine_handle<> coroutine_ = nullptr;
+    coroutine::detail::resume_work_item hop_;
 
     decltype(auto) get_return_value()
     {
@@ -27,12 +30,25 @@ protected:
     ptl::error_code ec_;
 
 public:
-    bool await_ready() {
-        return static_cast<DERIVED*>(this)->begin();
+    bool await_ready() noexcept {
+        return false;
     }
 
-    void await_suspend(std::experimental::coroutine_handle<> awaiting_coroutine) {
+    // The operation starts once the coroutine is recorded, so a completion reported from within
+    // begin() finds it.  Completing inline returns false and the coroutine just carries on: no
+    // resume() call, so a peer that is always ready cannot grow the stack.  Inline completions
+    // spend the cooperative budget, once it is gone the coroutine is queued behind the other
+    // work of its thread before it sees the result, so that peer cannot starve the loop either.
+    bool await_suspend(std::experimental::coroutine_handle<> awaiting_coroutine) {
         coroutine_ = awaiting_coroutine;
+        if (!static_cast<DERIVED*>(this)->begin()) {
+            return true;
+        }
+        if (execution::cooperative_budget::consume()) {
+            return false;
+        }
+        hop_.coroutine_ = awaiting_coroutine;
+        return coroutine::detail::reschedule(hop_);
     }
 
     decltype(auto) await_resume() {
@@ -40,7 +56,7 @@ public:
         using return_type = expected<derived_return_type>;
 
         if (ec_.value() != 0) {
-            return_type{ ec_ };
+            return return_type{ ec_ };
         }
         if constexpr(std::is_same_v<derived_return_type, void>) {
             // in case there is side effect
@@ -66,7 +82,7 @@ struct io_xfer_operation : public io_operation<DERIVED>
 
 
 protected:
-    size_t transferred_;
+    size_t transferred_ = 0;
 };
 
 } // namespace ptl::experimental::coroutine::asio::detail
\ No newline at end of file
@@ -1,11 +1,12 @@
 #pragma once
 //#include <mutex>
-#include <list>
+#include <unordered_map>
 #include <atomic>
 #include <ev.h>
 
 #include "ptl/experimental/coroutine/io_service/detail/io_service_definitions.hpp"
 #include "ptl/experimental/coroutine/io_service/descriptor.hpp"
+#include "ptl/execution/basic_executor.hpp"
 #include "ptl/expected.hpp"
 
 // FIXME: find a home:
@@ -23,7 +24,8 @@ static inline constexpr T* container_of( M *ptr, const M T::*member ) {
 
 typedef struct ev_io ev_io;
 struct ev_loop;
-struct ev_child;
+struct ev_signal;
+struct ev_async;
 
 namespace ptl::experimental::coroutine::iosvc::detail {
 
@@ -54,11 +56,26 @@ enum {
     shutdown_read_write,
 };
 
+// Each child is watched through its own pidfd registered with the event loop, so reaping is O(1)
+// and works with any io_service instance.  Kernels without pidfd_open fall back to a SIGCHLD
+// watcher and a pid-keyed map (only one io_service may use the fallback at a time).
 struct process_service_data {
+    process_service_data()
+        : pid(0)
+        , rc(0)
+        , pidfd(-1)
+        , exited(false)
+        , notification(nullptr)
+    {}
+
     int pid;
     int rc;
+    int pidfd;
+    bool exited;
     io_service_operation* notification;
+    ev_io ev_;
 };
+static_assert(std::is_standard_layout_v<process_service_data>);
 
 class io_service_impl
 {
@@ -69,6 +86,12 @@ public:
     void stop() noexcept;
     void run();
 
+    // Any thread: runs item on the loop thread, after the I/O already pending
+    void post(execution::work_item& item) noexcept;
+
+    // the io_service running on this thread, if any
+    static inline thread_local io_service_impl* current = nullptr;
+
     std::pair<descriptor::native_type, descriptor::native_type> create_pair(); 
 
     descriptor::native_type create_socket(int domain, int type, int protocol);
@@ -91,7 +114,7 @@ public:
     std::unique_ptr<detail::descriptor_service_data> register_descriptor(descriptor fd);
     void deregister_descriptor(descriptor fd, std::unique_ptr<detail::descriptor_service_data> data);
 
-    void register_process_notification(int pid, detail::process_service_data& data);
+    expected_void register_process_notification(int pid, detail::process_service_data& data);
     void deregister_process_notification(detail::process_service_data& data);
 
     void start_io(detail::descriptor_service_data &data, io_kind kind, io_service_operation *op);
@@ -101,12 +124,19 @@ public:
 
 private:
     struct ev_loop *event_loop_;
-    std::unique_ptr<ev_child> process_monitor_;
+    std::unique_ptr<ev_async> wakeup_;
+    std::unique_ptr<ev_signal> process_monitor_;
     std::atomic<bool> running_;
-    std::list<std::reference_wrapper<process_service_data>> process_watchers_;
+    execution::work_queue posted_;
+    std::unordered_map<int, std::reference_wrapper<process_service_data>> process_watchers_;
+
+    void process_exited(process_service_data& data, int status);
+    bool reap_watched(process_service_data& data);
 
     static void ev_notification(struct ev_loop* loop, ev_io* io, int events);
-    static void ev_process_change(struct ev_loop* loop, struct ev_child* child, int events);
+    static void ev_wakeup(struct ev_loop* loop, ev_async* async, int events);
+    static void ev_process_exit(struct ev_loop* loop, ev_io* io, int events);
+    static void ev_process_change(struct ev_loop* loop, struct ev_signal* signal, int events);
 };
 
 } // namespace ptl::experimental::coroutine::asio::detail
@@ -1,7 +1,9 @@
 #pragma once
 #include <cstddef>
 #include <memory>
+#include <experimental/coroutine>
 #include "ptl/experimental/coroutine/io_service/detail/io_service_impl.hpp"
+#include "ptl/experimental/coroutine/detail/schedule_awaitable.hpp"
 
 namespace ptl::experimental::coroutine::iosvc {
 
@@ -18,6 +20,32 @@ public:
 
     using io_service_impl::stop;
     using io_service_impl::run;
+    using io_service_impl::post;
+
+    // co_await svc.schedule() continues the coroutine on the loop thread
+    auto schedule() noexcept
+    {
+        struct awaitable
+        {
+            bool await_ready() const noexcept
+            {
+                return false;
+            }
+
+            void await_suspend(std::experimental::coroutine_handle<> coroutine) noexcept
+            {
+                item_.coroutine_ = coroutine;
+                service_.post(item_);
+            }
+
+            void await_resume() noexcept
+            {}
+
+            io_service_impl& service_;
+            coroutine::detail::resume_work_item item_;
+        };
+        return awaitable{ impl() };
+    }
 
     io_service_impl& impl() { return static_cast<io_service_impl&>(*this); }
 };
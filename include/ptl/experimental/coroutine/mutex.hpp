@@ -0,0 +1,157 @@
+#pragma once
+
+#if !defined(__clang__)
+#error Unsupported compiler
+#endif
+#include <experimental/coroutine>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <utility>
+
+#include "detail/async_waiter.hpp"
+
+namespace ptl::experimental::coroutine {
+
+class async_mutex;
+
+// Owns a locked async_mutex and unlocks it on destruction
+class async_mutex_lock
+{
+public:
+    explicit async_mutex_lock(async_mutex& mutex, std::adopt_lock_t) noexcept
+        : mutex_(&mutex)
+    {}
+
+    async_mutex_lock(async_mutex_lock&& other) noexcept
+        : mutex_(std::exchange(other.mutex_, nullptr))
+    {}
+
+    async_mutex_lock(const async_mutex_lock&) = delete;
+    async_mutex_lock& operator=(const async_mutex_lock&) = delete;
+
+    inline ~async_mutex_lock();
+
+private:
+    async_mutex* mutex_;
+};
+
+/* Mutex for coroutines: co_await lock() suspends the coroutine instead of blocking the thread.
+ *
+ * state_ is not_locked, locked_no_waiters or the head of a stack of newly arrived waiters.  The
+ * holder moves that stack into waiters_, a FIFO only the holder touches, so unlock() hands the
+ * mutex to the longest waiting coroutine and resumes it.  A waiter that unlocks while being resumed
+ * does not resume the next one recursively, see resume_waiters().
+ */
+class async_mutex
+{
+    static constexpr std::uintptr_t not_locked = 1;
+    static constexpr std::uintptr_t locked_no_waiters = 0;
+
+    class lock_operation : protected detail::async_waiter
+    {
+    public:
+        explicit lock_operation(async_mutex& mutex) noexcept
+            : mutex_(mutex)
+        {}
+
+        bool await_ready() noexcept
+        {
+            return mutex_.try_lock();
+        }
+
+        bool await_suspend(std::experimental::coroutine_handle<> coroutine) noexcept
+        {
+            coroutine_ = coroutine;
+            auto old = mutex_.state_.load(std::memory_order_acquire);
+            while (true) {
+                if (old == not_locked) {
+                    if (mutex_.state_.compare_exchange_weak(old, locked_no_waiters,
+                                                            std::memory_order_acquire, std::memory_order_relaxed)) {
+                        return false;
+                    }
+                } else {
+                    next_ = reinterpret_cast<detail::async_waiter*>(old);
+                    if (mutex_.state_.compare_exchange_weak(old, reinterpret_cast<std::uintptr_t>(static_cast<detail::async_waiter*>(this)),
+                                                            std::memory_order_release, std::memory_order_relaxed)) {
+                        return true;
+                    }
+                }
+            }
+        }
+
+        void await_resume() noexcept
+        {}
+
+    protected:
+        async_mutex& mutex_;
+    };
+
+    class scoped_lock_operation : public lock_operation
+    {
+    public:
+        using lock_operation::lock_operation;
+
+        [[nodiscard]] async_mutex_lock await_resume() noexcept
+        {
+            return async_mutex_lock{ mutex_, std::adopt_lock };
+        }
+    };
+
+public:
+    async_mutex() noexcept
+        : state_(not_locked)
+        , waiters_(nullptr)
+    {}
+
+    async_mutex(const async_mutex&) = delete;
+    async_mutex& operator=(const async_mutex&) = delete;
+
+    bool try_lock() noexcept
+    {
+        auto old = not_locked;
+        return state_.compare_exchange_strong(old, locked_no_waiters, std::memory_order_acquire, std::memory_order_relaxed);
+    }
+
+    // co_await mutex.lock(); ... mutex.unlock();
+    lock_operation lock() noexcept
+    {
+        return lock_operation{ *this };
+    }
+
+    // auto lock = co_await mutex.scoped_lock(); unlocks when lock goes out of scope
+    scoped_lock_operation scoped_lock() noexcept
+    {
+        return scoped_lock_operation{ *this };
+    }
+
+    void unlock() noexcept
+    {
+        auto waiter = waiters_;
+        if (waiter == nullptr) {
+            auto old = locked_no_waiters;
+            if (state_.compare_exchange_strong(old, not_locked, std::memory_order_release, std::memory_order_relaxed)) {
+                return;
+            }
+            old = state_.exchange(locked_no_waiters, std::memory_order_acquire);
+            waiter = detail::reverse_waiters(reinterpret_cast<detail::async_waiter*>(old));
+        }
+        // ownership passes to the waiter, which now owns waiters_ as well
+        waiters_ = waiter->next_;
+        waiter->next_ = nullptr;
+        detail::resume_waiters(waiter);
+    }
+
+private:
+    std::atomic<std::uintptr_t> state_;
+    detail::async_waiter* waiters_;
+};
+
+inline async_mutex_lock::~async_mutex_lock()
+{
+    if (mutex_) {
+        mutex_->unlock();
+    }
+}
+
+}
@@ -92,8 +92,7 @@ public:
 
         read_pipe_ = stdout_fds[0];
         write_pipe_ = stdin_fds[0];
-        service_.register_process_notification(pid, ps_data_);
-        return {};
+        return service_.register_process_notification(pid, ps_data_);
     }
 
 private:
@@ -103,7 +102,7 @@ private:
 
     bool terminated() const noexcept
     {
-        return terminated_;
+        return ps_data_.exited;
     }
 
     void start_io(iosvc::io_kind kind, iosvc::io_service_operation* op)
@@ -131,8 +130,6 @@ private:
 
     iosvc::descriptor read_pipe_;
     iosvc::descriptor write_pipe_;
-
-    bool terminated_ = false;
 };
 
 struct process_read_operation : iosvc::detail::io_xfer_operation<process_read_operation>, iosvc::io_service_operation
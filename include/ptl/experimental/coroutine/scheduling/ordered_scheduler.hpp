@@ -3,13 +3,19 @@
 #if !defined(__clang__)
 #error Unsupported compiler
 #endif
-#include <vector>
 #include <experimental/coroutine>
 #include "ptl/containers/bounded_ring_buffer.hpp"
 
 namespace ptl::experimental::coroutine {
 
-template<size_t N = 25>
+/* Round-robin scheduler: coroutines run in the order they were scheduled.
+ *
+ * Any thread may schedule() a coroutine, one consumer thread (typically the I/O thread) runs them
+ * through run_one()/run_pending() or by having its own coroutines yield(), which hands the thread
+ * straight to the oldest scheduled coroutine.  When the ring is full the awaiting coroutine simply
+ * keeps running.
+ */
+template<size_t N = 32>
 class OrderedScheduler
 {
 public:
@@ -19,6 +25,46 @@ public:
 
     }
 
+    // any thread: queue the awaiting coroutine behind the ones already scheduled
+    auto schedule() noexcept
+    {
+        return schedule_operation{ *this };
+    }
+
+    // consumer thread only: queue the awaiting coroutine and transfer to the oldest one
+    auto yield() noexcept
+    {
+        return yield_operation{ *this };
+    }
+
+    // consumer thread only
+    bool run_one()
+    {
+        if (auto h = ring_buffer_.pop()) {
+            h->resume();
+            return true;
+        }
+        return false;
+    }
+
+    // consumer thread only: runs what was scheduled before the call, coroutines scheduled while
+    // running wait for the next round
+    size_t run_pending()
+    {
+        size_t pending = ring_buffer_.count();
+        size_t ran = 0;
+        while (ran < pending && run_one()) {
+            ++ran;
+        }
+        return ran;
+    }
+
+    // any thread, a snapshot unless called from the consumer
+    bool empty() const noexcept
+    {
+        return ring_buffer_.count() == 0;
+    }
+
 private:
     struct schedule_operation
     {
@@ -31,6 +77,30 @@ private:
             return false;
         }
 
+        bool await_suspend(std::experimental::coroutine_handle<> awaiting_coroutine) noexcept
+        {
+            return scheduler_.ring_buffer_.try_push(awaiting_coroutine);
+        }
+
+        void await_resume() noexcept
+        {}
+
+    private:
+        OrderedScheduler& scheduler_;
+    };
+    friend struct schedule_operation;
+
+    struct yield_operation
+    {
+        explicit yield_operation(OrderedScheduler& s)
+            : scheduler_(s)
+        {}
+
+        bool await_ready() noexcept
+        {
+            return false;
+        }
+
         std::experimental::coroutine_handle<> await_suspend(
             std::experimental::coroutine_handle<> awaiting_coroutine) noexcept
         {
@@ -43,18 +113,22 @@ private:
     private:
         OrderedScheduler& scheduler_;
     };
-    friend struct schedule_operation;
+    friend struct yield_operation;
 
     std::experimental::coroutine_handle<> exchange_next(std::experimental::coroutine_handle<> handle)
     {
-        if (auto h = ring_buffer_.exchange(handle)) {
+        if (!ring_buffer_.try_push(handle)) {
+            return handle;
+        }
+        if (auto h = ring_buffer_.pop()) {
             return *h;
         }
+        // the oldest position is claimed but not yet published by its producer
         return noop_;
     }
 
     const std::experimental::coroutine_handle<> noop_;
-    ptl::bounded_ring_buffer<std::experimental::coroutine_handle<>, N> ring_buffer_;
+    ptl::bounded_ring_buffer<std::experimental::coroutine_handle<>, N, ptl::mpsc_lockless> ring_buffer_;
 };
 
-} // namespace ptl::experimental::coroutine
\ No newline at end of file
+} // namespace ptl::experimental::coroutine
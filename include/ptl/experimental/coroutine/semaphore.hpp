@@ -0,0 +1,49 @@
+#pragma once
+
+#if !defined(__clang__)
+#error Unsupported compiler
+#endif
+#include <experimental/coroutine>
+#include <cstddef>
+#include <limits>
+
+#include "detail/async_waiter.hpp"
+
+namespace ptl::experimental::coroutine {
+
+/* Counting semaphore, co_await acquire() suspends while no permit is available.  Waiters are
+ * released in FIFO order and release() resumes them inline.
+ */
+class async_semaphore
+{
+public:
+    explicit async_semaphore(std::ptrdiff_t initial,
+                             std::ptrdiff_t max = std::numeric_limits<std::ptrdiff_t>::max()) noexcept
+        : core_(initial, max)
+    {}
+
+    bool try_acquire() noexcept
+    {
+        return core_.try_acquire();
+    }
+
+    auto acquire() noexcept
+    {
+        return detail::async_semaphore_awaiter{ core_ };
+    }
+
+    void release(std::ptrdiff_t n = 1) noexcept
+    {
+        core_.release(n);
+    }
+
+    std::ptrdiff_t available() const noexcept
+    {
+        return core_.available();
+    }
+
+private:
+    detail::async_semaphore_core core_;
+};
+
+}
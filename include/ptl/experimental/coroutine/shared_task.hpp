@@ -0,0 +1,285 @@
+#pragma once
+
+#if !defined(__clang__)
+#error Unsupported compiler
+#endif
+#include <experimental/coroutine>
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <utility>
+#include "ptl/expected.hpp"
+
+#include "ptl/experimental/coroutine/detail/async_waiter.hpp"
+
+namespace ptl::experimental::coroutine {
+
+template <typename T>
+class shared_task;
+
+namespace detail {
+
+/* state_ is either one of two markers or the head of a lock-free stack of the waiters queued while
+ * the task runs.  The first awaiter moves it from not_started to an empty stack and starts the
+ * coroutine, completion swaps in completed and resumes everything that was queued.
+ */
+class shared_task_promise_base
+{
+public:
+    shared_task_promise_base() noexcept
+        : state_(not_started())
+        , refs_(1)
+    {}
+
+    std::experimental::suspend_always initial_suspend() noexcept
+    {
+        return {};
+    }
+
+    auto final_suspend() noexcept
+    {
+        return final_awaitable{};
+    }
+
+    bool is_ready() const noexcept
+    {
+        return state_.load(std::memory_order_acquire) == completed();
+    }
+
+    // false when the task has already completed and the awaiter must not suspend
+    bool try_await(async_waiter& waiter, std::experimental::coroutine_handle<> coroutine) noexcept
+    {
+        auto state = state_.load(std::memory_order_acquire);
+        if (state == not_started() &&
+            state_.compare_exchange_strong(state, nullptr, std::memory_order_relaxed, std::memory_order_acquire)) {
+            coroutine.resume();
+            state = state_.load(std::memory_order_acquire);
+        }
+        do {
+            if (state == completed()) {
+                return false;
+            }
+            waiter.next_ = static_cast<async_waiter*>(state);
+        } while (!state_.compare_exchange_weak(state, &waiter, std::memory_order_release, std::memory_order_acquire));
+        return true;
+    }
+
+    void add_ref() noexcept
+    {
+        refs_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // true when the last reference is gone
+    bool release() noexcept
+    {
+        return refs_.fetch_sub(1, std::memory_order_acq_rel) == 1;
+    }
+
+private:
+    // waiters are pointer aligned, neither marker can be a waiter's address
+    static void* not_started() noexcept
+    {
+        return reinterpret_cast<void*>(std::uintptr_t{1});
+    }
+
+    static void* completed() noexcept
+    {
+        return reinterpret_cast<void*>(std::uintptr_t{2});
+    }
+
+    std::atomic<void*> state_;
+    std::atomic<uint32_t> refs_;
+
+    friend struct final_awaitable;
+    struct final_awaitable
+    {
+        bool await_ready() const noexcept
+        {
+            return false;
+        }
+
+        // a resumed waiter may drop the last reference and destroy this frame, nothing is read
+        // from it once the waiters are detached
+        template <typename PROMISE>
+        void await_suspend(std::experimental::coroutine_handle<PROMISE> coroutine) noexcept
+        {
+            auto& promise = static_cast<shared_task_promise_base&>(coroutine.promise());
+            auto head = promise.state_.exchange(completed(), std::memory_order_acq_rel);
+            auto waiter = reverse_waiters(static_cast<async_waiter*>(head));
+            while (waiter) {
+                auto next = waiter->next_;
+                waiter->coroutine_.resume();
+                waiter = next;
+            }
+        }
+
+        void await_resume() noexcept
+        {}
+    };
+};
+
+template <typename T>
+class shared_task_promise final : public shared_task_promise_base
+{
+public:
+    shared_task<T> get_return_object() noexcept;
+
+    void unhandled_exception() noexcept
+    {
+        value_ = storage(std::current_exception());
+    }
+
+    template <typename VALUE_TYPE, typename = std::enable_if_t<std::is_convertible_v<VALUE_TYPE&&, T>>>
+    void return_value(VALUE_TYPE&& value) noexcept(std::is_nothrow_constructible_v<T, VALUE_TYPE&&>)
+    {
+        value_ = storage(std::forward<VALUE_TYPE>(value));
+    }
+
+    const T& result() const
+    {
+        return value_.value();
+    }
+
+private:
+    using storage = ptl::expected<T, std::exception_ptr, ptl::error_policy_throw>;
+    storage value_;
+};
+
+template <>
+class shared_task_promise<void> final : public shared_task_promise_base
+{
+public:
+    shared_task<void> get_return_object() noexcept;
+
+    void unhandled_exception() noexcept
+    {
+        value_ = storage(std::current_exception());
+    }
+
+    void return_void() noexcept
+    {}
+
+    void result() const
+    {
+        value_.value();
+    }
+
+private:
+    using storage = ptl::expected<void, std::exception_ptr, ptl::error_policy_throw>;
+    storage value_;
+};
+
+} // namespace detail
+
+/* shared_task<T> is a lazily started task that any number of coroutines can co_await, from any
+ * thread.  The first co_await starts it, later ones queue on a lock-free list and all of them are
+ * resumed on the completing thread, each getting a const T& to the one result (or the exception).
+ * Copies share the coroutine, which lives until the last copy goes away.
+ */
+template <typename T = void>
+class [[nodiscard]] shared_task
+{
+public:
+    using promise_type = detail::shared_task_promise<T>;
+    using value_type = T;
+
+    shared_task() noexcept
+        : coroutine_(nullptr)
+    {}
+
+    explicit shared_task(std::experimental::coroutine_handle<promise_type> coroutine) noexcept
+        : coroutine_(coroutine)
+    {}
+
+    shared_task(const shared_task& other) noexcept
+        : coroutine_(other.coroutine_)
+    {
+        if (coroutine_) {
+            coroutine_.promise().add_ref();
+        }
+    }
+
+    shared_task(shared_task&& other) noexcept
+        : coroutine_(std::exchange(other.coroutine_, nullptr))
+    {}
+
+    ~shared_task()
+    {
+        destroy();
+    }
+
+    shared_task& operator=(shared_task other) noexcept
+    {
+        std::swap(coroutine_, other.coroutine_);
+        return *this;
+    }
+
+    bool is_ready() const noexcept
+    {
+        return !coroutine_ || coroutine_.promise().is_ready();
+    }
+
+    auto operator co_await() const noexcept
+    {
+        struct awaitable
+        {
+            bool await_ready() const noexcept
+            {
+                return !coroutine_ || coroutine_.promise().is_ready();
+            }
+
+            bool await_suspend(std::experimental::coroutine_handle<> awaiting_coroutine) noexcept
+            {
+                waiter_.coroutine_ = awaiting_coroutine;
+                return coroutine_.promise().try_await(waiter_, coroutine_);
+            }
+
+            decltype(auto) await_resume() const
+            {
+                return coroutine_.promise().result();
+            }
+
+            std::experimental::coroutine_handle<promise_type> coroutine_;
+            detail::async_waiter waiter_;
+        };
+
+        return awaitable{ coroutine_, {} };
+    }
+
+    bool operator==(const shared_task& other) const noexcept
+    {
+        return coroutine_ == other.coroutine_;
+    }
+
+    bool operator!=(const shared_task& other) const noexcept
+    {
+        return !(*this == other);
+    }
+
+private:
+    void destroy() noexcept
+    {
+        if (coroutine_ && coroutine_.promise().release()) {
+            coroutine_.destroy();
+        }
+    }
+
+    std::experimental::coroutine_handle<promise_type> coroutine_;
+};
+
+namespace detail {
+
+template <typename T>
+shared_task<T> shared_task_promise<T>::get_return_object() noexcept
+{
+    return shared_task<T>{std::experimental::coroutine_handle<shared_task_promise>::from_promise(*this)};
+}
+
+inline shared_task<void> shared_task_promise<void>::get_return_object() noexcept
+{
+    return shared_task<void>{std::experimental::coroutine_handle<shared_task_promise>::from_promise(*this)};
+}
+
+} // namespace detail
+
+} // namespace ptl::experimental::coroutine
@@ -3,7 +3,9 @@
 #error Unsupported compiler
 #endif
 #include <experimental/coroutine>
-#include <cstdio>
+#include <cstddef>
+#include <new>
+#include <type_traits>
 
 #include "awaitable_traits.hpp"
 #include "ptl/sync/event.hpp"
@@ -11,304 +13,155 @@
 namespace ptl::experimental::coroutine {
 namespace detail {
 
-template <typename T>
-class async_wait_task;
-template <typename T>
-class sync_wait_task;
-
-template<typename T, typename DERIVED>
-class wait_task_promise_base
+// Room for the frame of wait_resumer, which lives on the waiting thread's stack.  Compilers that
+// need more fall back to the heap.
+struct alignas(std::max_align_t) wait_frame_storage
 {
-protected:
-    using coroutine_handle_t = std::experimental::coroutine_handle<DERIVED>;
-    using reference = T&&;
-
-    wait_task_promise_base() noexcept = default;
-
-    void base_start()
-    {
-        auto coro = coroutine_handle_t::from_promise(*static_cast<DERIVED*>(this));
-        coro.resume();
-    }
-
-public:
-    auto get_return_object() noexcept
-    {
-        return coroutine_handle_t::from_promise(*static_cast<DERIVED*>(this));
-    }
-
-    auto initial_suspend() noexcept
-    {
-        return typename DERIVED::initial_suspend_type{};
-    }
-
-    auto final_suspend() noexcept
-    {
-        return typename DERIVED::final_suspend_type{};
-    }
+    static constexpr size_t size = 16 * sizeof(void*);
 
-    auto yield_value(reference result) noexcept
-    {
-        result_ = std::addressof(result);
-        return final_suspend();
-    }
-
-    void return_void() noexcept
-    {
-        assert(false);
-    }
-
-    void unhandled_exception() noexcept
-    {
-        exception_ = std::current_exception();
-    }
-
-    reference result()
-    {
-        if (exception_) {
-            std::rethrow_exception(exception_);
-        }
-        return static_cast<reference>(*result_);
-    }
-
-private:
-    std::remove_reference_t<T>* result_;
-    std::exception_ptr exception_;
+    unsigned char buffer_[size];
 };
 
-template <typename DERIVED>
-class wait_task_promise_base<void, DERIVED>
+// The coroutine handed to await_suspend.  It does nothing but set the event of the waiting thread
+// when resumed, so its frame does not depend on the awaitable and always fits in the storage.
+class wait_resumer final
 {
-protected:
-    using coroutine_handle_t = std::experimental::coroutine_handle<DERIVED>;
-
-    wait_task_promise_base() noexcept = default;
-
-    void base_start()
-    {
-        auto coro = coroutine_handle_t::from_promise(*static_cast<DERIVED*>(this));
-        coro.resume();
-    }
-
 public:
-    auto get_return_object() noexcept
-    {
-        return coroutine_handle_t::from_promise(*static_cast<DERIVED*>(this));
-    }
-
-    auto initial_suspend() noexcept
-    {
-        return typename DERIVED::initial_suspend_type{};
-    }
-
-    auto final_suspend() noexcept
-    {
-        return typename DERIVED::final_suspend_type{};
-    }
-
-    void return_void() noexcept
-    {}
-
-    void unhandled_exception() noexcept
+    struct promise_type
     {
-        exception_ = std::current_exception();
-    }
+        ptl::sync::manual_reset_event* event_ = nullptr;
 
-    void result()
-    {
-        if (exception_) {
-            std::rethrow_exception(exception_);
+        static void* operator new(size_t sz, wait_frame_storage& storage)
+        {
+            if (sz <= wait_frame_storage::size) {
+                return storage.buffer_;
+            }
+            return ::operator new(sz);
         }
-    }
-
-private:
-    std::exception_ptr exception_;
-};
-
 
-
-template <typename T>
-class async_wait_task_promise final : public wait_task_promise_base<T, async_wait_task_promise<T>>
-{
-    using super = wait_task_promise_base<T, async_wait_task_promise<T>>;
-private:
-    class completion_notifier
-    {
-    public:
-        bool await_ready() const noexcept
+        static void operator delete(void* ptr, size_t sz) noexcept
         {
-            return false;
+            if (sz > wait_frame_storage::size) {
+                ::operator delete(ptr);
+            }
         }
 
-        void await_suspend(typename super::coroutine_handle_t coroutine) const noexcept
+        wait_resumer get_return_object() noexcept
         {
-            coroutine.promise().event_->set();
+            return wait_resumer{std::experimental::coroutine_handle<promise_type>::from_promise(*this)};
         }
 
-        void await_resume() noexcept
+        std::experimental::suspend_always initial_suspend() noexcept
         {
+            return {};
         }
-    };
-
-    ptl::sync::manual_reset_event* event_;
-
-public:
-    using initial_suspend_type = std::experimental::suspend_always;
-    using final_suspend_type = completion_notifier;
-
-    void start(ptl::sync::manual_reset_event& event)
-    {
-        event_ = &event;
-        this->base_start();
-    }
-
-};
-
-template <typename T>
-class sync_wait_task_promise final : public wait_task_promise_base<T, sync_wait_task_promise<T>>
-{
-    using super = wait_task_promise_base<T, async_wait_task_promise<T>>;
-
-public:
-    using initial_suspend_type = std::experimental::suspend_always;
-    using final_suspend_type = std::experimental::suspend_always;
-
-    void start()
-    {
-        this->base_start();
-    }
-};
-
-template <typename T>
-class async_wait_task final
-{
-public:
-    using promise_type = async_wait_task_promise<T>;
-    using coroutine_handle_t = std::experimental::coroutine_handle<promise_type>;
-
-    async_wait_task(coroutine_handle_t coroutine) noexcept
-        : coroutine_(coroutine)
-    {
-    }
-
-    async_wait_task(async_wait_task&& other) noexcept
-        : coroutine_(std::exchange(other.coroutine_, coroutine_handle_t{}))
-    {}
 
-    ~async_wait_task()
-    {
-        if (coroutine_) {
-            coroutine_.destroy();
+        auto final_suspend() noexcept
+        {
+            struct notifier
+            {
+                bool await_ready() const noexcept
+                {
+                    return false;
+                }
+
+                // the waiting thread may leave as soon as the event is set, the frame must not be
+                // touched after that
+                void await_suspend(std::experimental::coroutine_handle<promise_type> coroutine) noexcept
+                {
+                    coroutine.promise().event_->set();
+                }
+
+                void await_resume() noexcept
+                {}
+            };
+            return notifier{};
         }
-    }
-
-    async_wait_task(const async_wait_task&) = delete;
-    async_wait_task& operator=(const async_wait_task&) = delete;
-
-    void start(ptl::sync::manual_reset_event& event) noexcept
-    {
-        coroutine_.promise().start(event);
-    }
 
-    decltype(auto) result()
-    {
-        return coroutine_.promise().result();
-    }
-
-private:
-    coroutine_handle_t coroutine_;
-};
+        void return_void() noexcept
+        {}
 
-template <typename T>
-class sync_wait_task final
-{
-public:
-    using promise_type = sync_wait_task_promise<T>;
-    using coroutine_handle_t = std::experimental::coroutine_handle<promise_type>;
+        void unhandled_exception() noexcept
+        {}
+    };
 
-    sync_wait_task(coroutine_handle_t coroutine) noexcept
+    explicit wait_resumer(std::experimental::coroutine_handle<promise_type> coroutine) noexcept
         : coroutine_(coroutine)
-    {
-    }
-
-    sync_wait_task(sync_wait_task&& other) noexcept
-        : coroutine_(std::exchange(other.coroutine_, coroutine_handle_t{}))
     {}
 
-    ~sync_wait_task()
-    {
-        if (coroutine_) {
-            coroutine_.destroy();
-        }
-    }
-
-    sync_wait_task(const sync_wait_task&) = delete;
-    sync_wait_task& operator=(const sync_wait_task&) = delete;
+    wait_resumer(const wait_resumer&) = delete;
+    wait_resumer& operator=(const wait_resumer&) = delete;
 
-    void start() noexcept
+    ~wait_resumer()
     {
-        coroutine_.promise().start();
+        coroutine_.destroy();
     }
 
-    decltype(auto) result()
+    std::experimental::coroutine_handle<> start(ptl::sync::manual_reset_event& event) noexcept
     {
-        return coroutine_.promise().result();
+        coroutine_.promise().event_ = &event;
+        return coroutine_;
     }
 
 private:
-    coroutine_handle_t coroutine_;
+    std::experimental::coroutine_handle<promise_type> coroutine_;
 };
 
-template <typename AWAITABLE, typename RESULT = typename awaitable_traits<AWAITABLE&&>::await_result_t,
-          std::enable_if_t<!std::is_void_v<RESULT>, int> = 0>
-async_wait_task<RESULT> make_async_wait_task(AWAITABLE&& awaitable)
+inline wait_resumer make_wait_resumer(wait_frame_storage&)
 {
-    co_yield co_await std::forward<AWAITABLE>(awaitable);
+    co_return;
 }
 
-template <typename AWAITABLE, typename RESULT = typename awaitable_traits<AWAITABLE&&>::await_result_t,
-          std::enable_if_t<std::is_void_v<RESULT>, int> = 0>
-async_wait_task<RESULT> make_async_wait_task(AWAITABLE&& awaitable)
-{
-    co_return co_await std::forward<AWAITABLE>(awaitable);
-}
-
-template <typename AWAITABLE, typename RESULT = typename awaitable_traits<AWAITABLE&&>::await_result_t,
-          std::enable_if_t<!std::is_void_v<RESULT>, int> = 0>
-sync_wait_task<RESULT> make_sync_wait_task(AWAITABLE&& awaitable)
+// Drives the awaiter protocol by hand from a plain function: the awaiter, the resumer frame and the
+// event all live on this stack, and the result or exception comes straight out of await_resume().
+// An awaiter that is ready, or that completes within await_suspend, never touches the event.
+template <typename AWAITABLE>
+auto blocking_wait(AWAITABLE&& awaitable) -> typename awaitable_traits<AWAITABLE&&>::await_result_t
 {
-    co_yield co_await std::forward<AWAITABLE>(awaitable);
-}
+    decltype(auto) awaiter = get_awaiter(std::forward<AWAITABLE>(awaitable));
+    if (awaiter.await_ready()) {
+        return awaiter.await_resume();
+    }
 
-template <typename AWAITABLE, typename RESULT = typename awaitable_traits<AWAITABLE&&>::await_result_t,
-          std::enable_if_t<std::is_void_v<RESULT>, int> = 0>
-sync_wait_task<RESULT> make_sync_wait_task(AWAITABLE&& awaitable)
-{
-    co_return co_await std::forward<AWAITABLE>(awaitable);
+    wait_frame_storage storage;
+    ptl::sync::manual_reset_event event;
+    wait_resumer resumer = make_wait_resumer(storage);
+    auto coroutine = resumer.start(event);
+
+    using suspend_result_t = decltype(awaiter.await_suspend(coroutine));
+    if constexpr (std::is_void_v<suspend_result_t>) {
+        awaiter.await_suspend(coroutine);
+        event.wait();
+    } else if constexpr (std::is_same_v<suspend_result_t, bool>) {
+        if (awaiter.await_suspend(coroutine)) {
+            event.wait();
+        }
+    } else {
+        auto next = awaiter.await_suspend(coroutine);
+        if (next != coroutine) {
+            next.resume();
+            event.wait();
+        }
+    }
+    return awaiter.await_resume();
 }
 
-
 } // namespace detail
 
+/* Both block the calling thread until the awaitable completes, wherever it completes, and return
+ * its result.  Neither allocates: the state of the wait is kept on the caller's stack.
+ */
 template <typename AWAITABLE>
 auto async_wait(AWAITABLE&& awaitable) -> typename awaitable_traits<AWAITABLE&&>::await_result_t
 {
-    auto task = detail::make_async_wait_task<AWAITABLE>(std::forward<AWAITABLE>(awaitable));
-
-    ptl::sync::manual_reset_event event;
-    task.start(event);
-    event.wait();
-    return task.result();
+    return detail::blocking_wait(std::forward<AWAITABLE>(awaitable));
 }
 
 template <typename AWAITABLE>
 auto sync_wait(AWAITABLE&& awaitable) -> typename awaitable_traits<AWAITABLE&&>::await_result_t
 {
-    auto task = detail::make_sync_wait_task<AWAITABLE>(std::forward<AWAITABLE>(awaitable));
-
-    task.start();
-    return task.result();
+    return detail::blocking_wait(std::forward<AWAITABLE>(awaitable));
 }
 
 
-} // namespace ptl::experimental::coroutine
\ No newline at end of file
+} // namespace ptl::experimental::coroutine
@@ -6,6 +6,7 @@
 #include <experimental/coroutine>
 #include "ptl/scope_guard.hpp"
 #include "ptl/expected.hpp"
+#include "ptl/pool_allocator.hpp"
 
 #include "ptl/experimental/coroutine/detail/schedule_awaitable.hpp"
 #include "ptl/experimental/coroutine/scheduling/ordered_scheduler.hpp"
@@ -36,12 +37,20 @@ public:
         executor_ = execution::Executor::current;
     }
 
+    // Start the task on ex instead of inline.  The hop reuses the promise's embedded work item,
+    // which is free again by the time the task completes.
+    void schedule_on(execution::Executor* ex, std::experimental::coroutine_handle<> self) noexcept
+    {
+        hop_.coroutine_ = self;
+        ex->post(hop_);
+    }
+
+    // Frames come from the per-thread size class pool
     void* operator new(std::size_t sz) {
-        //printf("promise new: %lu\n", sz);
-        return ::operator new(sz);
+        return pool_allocate(sz);
     }
     void operator delete(void* ptr, std::size_t sz) {
-        return ::operator delete(ptr, sz);
+        pool_deallocate(ptr, sz);
     }
 
 protected:
@@ -52,6 +61,7 @@ protected:
 private:
     std::experimental::coroutine_handle<> continuation_;
     execution::Executor* executor_;
+    resume_work_item hop_;
 
     friend struct final_awaitable;
     struct final_awaitable
@@ -61,6 +71,9 @@ private:
             return false;
         }
 
+        // Completing on the awaiting executor (or without one) transfers straight to the
+        // continuation, otherwise the continuation is posted back to its executor through the
+        // work item embedded in the promise: no allocation and no std::function.
         template <typename T>
         std::experimental::coroutine_handle<> await_suspend(std::experimental::coroutine_handle<T> coroutine) noexcept
         {
@@ -68,7 +81,8 @@ private:
             if (promise.executor_ == nullptr || promise.executor_ == execution::Executor::current) {
                 return promise.continuation_;
             }
-            promise.executor_->add([coroutine = promise.continuation_]() mutable { coroutine.resume(); });
+            promise.hop_.coroutine_ = promise.continuation_;
+            promise.executor_->post(promise.hop_);
             return std::experimental::noop_coroutine();
         }
 
@@ -284,9 +298,8 @@ public:
 
             void await_suspend(std::experimental::coroutine_handle<> awaiting_coroutine) noexcept
             {
-                //auto& promise
                 coroutine_.promise().set_continuation(awaiting_coroutine);
-                executor_->add([coroutine = coroutine_]() mutable { coroutine.resume(); });
+                coroutine_.promise().schedule_on(executor_, coroutine_);
             }
 
             decltype(auto) await_resume()
@@ -12,7 +12,22 @@ auto wait_all(AWAITABLES&&... awaitables)
 {
     return detail::wait_all_awaitable<std::tuple<detail::wait_all_task<typename awaitable_traits<std::remove_reference_t<AWAITABLES>>::await_result_t>...>>(
         std::make_tuple(detail::make_wait_all_task(std::forward<AWAITABLES>(awaitables))...));
-    
+}
+
+// Runtime sized fan-out: co_await yields a std::vector with one result per awaitable (or void).
+// Tasks start inline on the awaiting thread, or are all posted to ex when one is given.
+template<typename AWAITABLE,
+         std::enable_if_t<detail::is_awaitable<AWAITABLE>::value, int> = 0>
+auto wait_all(std::vector<AWAITABLE> awaitables, execution::Executor* ex = nullptr)
+{
+    using task_type = detail::wait_all_task<typename awaitable_traits<AWAITABLE>::await_result_t>;
+
+    std::vector<task_type> tasks;
+    tasks.reserve(awaitables.size());
+    for (auto& awaitable : awaitables) {
+        tasks.emplace_back(detail::make_wait_all_task(std::move(awaitable)));
+    }
+    return detail::wait_all_range_awaitable<task_type>(std::move(tasks), ex);
 }
 
 }
\ No newline at end of file
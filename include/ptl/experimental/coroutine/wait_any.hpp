@@ -0,0 +1,62 @@
+#pragma once
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include "awaitable_traits.hpp"
+#include "detail/is_awaiter.hpp"
+#include "detail/wait_any_task.hpp"
+#include "detail/wait_any_awaiter.hpp"
+
+namespace ptl::experimental::coroutine {
+
+/* wait_any races awaitables: the first one to complete wins and yields its index together with
+ * its value (or only the index for void results), an exception of the winner is rethrown.
+ *
+ * The winner requests cancellation on the source, the awaitables built with one of its tokens can
+ * stop early.  The awaiting coroutine resumes only once every loser has completed too, so nothing
+ * a loser still uses goes away under it; a loser that ignores the token delays the result until
+ * it is done.  Awaitables not yet started when the race is decided never run.
+ *
+ *   asio::cancellation_source source;
+ *   auto [index, reply] = co_await wait_any(source, fetch(primary, source.token()), fetch(backup, source.token()));
+ */
+template<typename... AWAITABLES,
+         std::enable_if_t<std::conjunction_v<detail::is_awaitable<std::remove_reference_t<AWAITABLES>>...>, int> = 0>
+auto wait_any(asio::cancellation_source source, AWAITABLES&&... awaitables)
+{
+    using result_type = std::common_type_t<std::decay_t<typename awaitable_traits<std::remove_reference_t<AWAITABLES>>::await_result_t>...>;
+
+    std::vector<detail::wait_any_task<result_type>> tasks;
+    tasks.reserve(sizeof...(AWAITABLES));
+    (tasks.emplace_back(detail::make_wait_any_task<result_type>(std::forward<AWAITABLES>(awaitables))), ...);
+    return detail::wait_any_awaitable<result_type>(std::move(tasks), std::move(source));
+}
+
+template<typename... AWAITABLES,
+         std::enable_if_t<std::conjunction_v<detail::is_awaitable<std::remove_reference_t<AWAITABLES>>...>, int> = 0>
+auto wait_any(AWAITABLES&&... awaitables)
+{
+    return wait_any(asio::cancellation_source{}, std::forward<AWAITABLES>(awaitables)...);
+}
+
+// A race needs a runner: an empty vector throws std::invalid_argument
+template<typename AWAITABLE,
+         std::enable_if_t<detail::is_awaitable<AWAITABLE>::value, int> = 0>
+auto wait_any(std::vector<AWAITABLE> awaitables, asio::cancellation_source source = asio::cancellation_source{})
+{
+    if (awaitables.empty()) {
+        throw std::invalid_argument("wait_any of an empty range");
+    }
+
+    using result_type = std::decay_t<typename awaitable_traits<AWAITABLE>::await_result_t>;
+
+    std::vector<detail::wait_any_task<result_type>> tasks;
+    tasks.reserve(awaitables.size());
+    for (auto& awaitable : awaitables) {
+        tasks.emplace_back(detail::make_wait_any_task<result_type>(std::move(awaitable)));
+    }
+    return detail::wait_any_awaitable<result_type>(std::move(tasks), std::move(source));
+}
+
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#if !defined(__clang__)
+#error Unsupported compiler
+#endif
+#include <experimental/coroutine>
+
+#include "ptl/execution/basic_executor.hpp"
+#include "ptl/experimental/coroutine/detail/schedule_awaitable.hpp"
+#include "ptl/experimental/coroutine/io_service/detail/io_service_impl.hpp"
+
+namespace ptl::experimental::coroutine {
+
+namespace detail {
+
+// Queues item behind the work already pending on whatever drives this thread: the io_service
+// running on it, otherwise its executor.  False when the thread has neither.
+inline bool reschedule(resume_work_item& item) noexcept
+{
+    if (auto service = iosvc::detail::io_service_impl::current) {
+        service->post(item);
+        return true;
+    }
+    if (auto executor = execution::Executor::current) {
+        executor->post(item);
+        return true;
+    }
+    return false;
+}
+
+} // namespace detail
+
+/* co_await yield() lets everything already pending on this thread run before the coroutine
+ * continues.  Coroutines on an OrderedScheduler consumer use scheduler.yield() instead.
+ */
+inline auto yield() noexcept
+{
+    struct awaitable
+    {
+        bool await_ready() const noexcept
+        {
+            return false;
+        }
+
+        bool await_suspend(std::experimental::coroutine_handle<> coroutine) noexcept
+        {
+            item_.coroutine_ = coroutine;
+            return detail::reschedule(item_);
+        }
+
+        void await_resume() noexcept
+        {}
+
+        detail::resume_work_item item_;
+    };
+    return awaitable{};
+}
+
+} // namespace ptl::experimental::coroutine
@@ -1,6 +1,12 @@
 #pragma once
 #include <type_traits>
+#include <algorithm>
 #include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <utility>
 #include "ptl/compiler.hpp"
 
 namespace ptl {
@@ -111,7 +117,11 @@ private:
     intrusive_wptr(T* ptr)
         : ptr_(ptr)
     {
-        intrusive_wptr_add_ref(ptr_);
+        if constexpr (has_intrusive_ptr_api::value) {
+            ptr_->intrusive_wptr_add_ref();
+        } else {
+            intrusive_wptr_add_ref(ptr_);
+        }
     }
 
     struct has_intrusive_ptr_api {
@@ -265,6 +275,12 @@ public:
         return ptr_;
     }
 
+    // Gives up ownership without releasing, the reference now belongs to the caller
+    T* detach() noexcept
+    {
+        return std::exchange(ptr_, nullptr);
+    }
+
     T* operator->() const noexcept {
         return ptr_;
     }
@@ -311,42 +327,305 @@ inline intrusive_ptr<T> intrusive_wptr<T>::lock()
     return intrusive_ptr<T>();
 }
 
-struct intrusive_strong_reference
+// Every reference is counted with atomic read-modify-writes
+struct intrusive_refcount_atomic {};
+// The thread that creates the object counts its own references without atomics, other threads share
+// an atomic counter.  Pays off for objects mostly copied by the thread that made them.
+struct intrusive_refcount_biased {};
+
+template <typename POLICY = intrusive_refcount_atomic>
+struct basic_intrusive_strong_reference;
+
+template <>
+struct basic_intrusive_strong_reference<intrusive_refcount_atomic>
 {
-    intrusive_strong_reference() : references{ 1 } { }
-    
+    basic_intrusive_strong_reference() : references{ 1 } { }
+
     std::atomic<uint32_t> references;
 };
 
-inline
-void intrusive_strong_ptr_add_ref(intrusive_strong_reference* ptr)
+namespace detail {
+class intrusive_biased_owner;
+}
+
+/* Biased counting: the owner's references live in local, everybody else's in shared, which goes
+ * negative when another thread drops a reference the owner made.  The owner merges local into
+ * shared when local drops to zero, flagging shared; from then on every thread counts in shared and
+ * the object dies when shared is back to the bare flag.
+ *
+ * A thread whose release would take an unmerged shared to zero or below may be dropping the owner's
+ * last references, which local alone would never notice.  The decision is made by a CAS on shared,
+ * so two such releases cannot both slip past it.  That thread keeps its reference and queues the
+ * object on its owner instead; the owner merges it and drops that reference the next time it
+ * releases a reference of its own, in intrusive_biased_collect(), or when it exits.  While the
+ * object is queued a merge is on its way, other threads decrement shared freely.
+ */
+template <>
+struct basic_intrusive_strong_reference<intrusive_refcount_biased>
+{
+    static constexpr int64_t merged_flag = int64_t(1) << 48;
+
+    basic_intrusive_strong_reference();
+
+    bool owned_here() const noexcept;
+
+    detail::intrusive_biased_owner* const owner;
+    uint32_t local;                 // owner thread only
+    bool merged;                    // owner thread only
+    std::atomic<bool> queued;
+    std::atomic<int64_t> shared;
+
+    // filled in by the thread queueing the object
+    basic_intrusive_strong_reference* next_queued;
+    void* derived;
+    void (*collect)(basic_intrusive_strong_reference*);
+};
+
+namespace detail {
+
+class intrusive_biased_owner
 {
-    ptr->references++;
+public:
+    using reference = basic_intrusive_strong_reference<intrusive_refcount_biased>;
+
+    static inline thread_local intrusive_biased_owner* current = nullptr;
+
+    // Every object made by the thread holds its owner, so queueing never outlives it
+    static intrusive_biased_owner* acquire()
+    {
+        if (current == nullptr) {
+            static thread_local exit_guard guard;
+            guard.owner = current = new intrusive_biased_owner;
+        }
+        current->references_.fetch_add(1, std::memory_order_relaxed);
+        return current;
+    }
+
+    void release() noexcept
+    {
+        if (references_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            delete this;
+        }
+    }
+
+    // false once the owner has exited, the caller then collects the object itself
+    bool push(reference* ref) noexcept
+    {
+        auto head = queue_.load(std::memory_order_relaxed);
+        do {
+            if (head == closed()) {
+                std::atomic_thread_fence(std::memory_order_acquire);
+                return false;
+            }
+            ref->next_queued = head;
+        } while (!queue_.compare_exchange_weak(head, ref, std::memory_order_release, std::memory_order_relaxed));
+        return true;
+    }
+
+    // owner thread only
+    void collect() noexcept
+    {
+        if (queue_.load(std::memory_order_relaxed) != nullptr) {
+            collect(queue_.exchange(nullptr, std::memory_order_acquire));
+        }
+    }
+
+private:
+    struct exit_guard
+    {
+        ~exit_guard()
+        {
+            current = nullptr;
+            owner->collect(owner->queue_.exchange(closed(), std::memory_order_acq_rel));
+            owner->release();
+        }
+
+        intrusive_biased_owner* owner = nullptr;
+    };
+
+    static reference* closed() noexcept
+    {
+        return reinterpret_cast<reference*>(uintptr_t(1));
+    }
+
+    static void collect(reference* ref) noexcept
+    {
+        while (ref != nullptr) {
+            auto next = ref->next_queued;
+            ref->collect(ref);
+            ref = next;
+        }
+    }
+
+    std::atomic<reference*> queue_{ nullptr };
+    std::atomic<uint32_t> references_{ 1 };     // the thread's own
+};
+
+template<typename T>
+void intrusive_biased_destroy(basic_intrusive_strong_reference<intrusive_refcount_biased>* ptr, T* derived)
+{
+    auto owner = ptr->owner;
+    delete derived;
+    owner->release();
 }
 
 template<typename T>
+void intrusive_biased_release_shared(basic_intrusive_strong_reference<intrusive_refcount_biased>* ptr, T* derived)
+{
+    using reference = basic_intrusive_strong_reference<intrusive_refcount_biased>;
+    if (ptr->shared.fetch_sub(1, std::memory_order_release) == reference::merged_flag + 1) {
+        std::atomic_thread_fence(std::memory_order_acquire);
+        intrusive_biased_destroy(ptr, derived);
+    }
+}
+
+template<typename T>
+void intrusive_biased_collect_one(basic_intrusive_strong_reference<intrusive_refcount_biased>* ptr);
+
+// Release by a thread other than the owner
+template<typename T>
+void intrusive_biased_release_remote(basic_intrusive_strong_reference<intrusive_refcount_biased>* ptr, T* derived)
+{
+    using reference = basic_intrusive_strong_reference<intrusive_refcount_biased>;
+    auto count = ptr->shared.load(std::memory_order_relaxed);
+    while (count > 1 && count < reference::merged_flag) {
+        if (ptr->shared.compare_exchange_weak(count, count - 1, std::memory_order_release, std::memory_order_relaxed)) {
+            return;
+        }
+    }
+    if (count < reference::merged_flag && !ptr->queued.exchange(true, std::memory_order_relaxed)) {
+        ptr->derived = derived;
+        ptr->collect = &intrusive_biased_collect_one<T>;
+        if (!ptr->owner->push(ptr)) {
+            intrusive_biased_collect_one<T>(ptr);
+        }
+        return;
+    }
+    intrusive_biased_release_shared(ptr, derived);
+}
+
+// Runs on the owner thread, or anywhere once the owner has exited
+template<typename T>
+void intrusive_biased_collect_one(basic_intrusive_strong_reference<intrusive_refcount_biased>* ptr)
+{
+    using reference = basic_intrusive_strong_reference<intrusive_refcount_biased>;
+    if (!ptr->merged) {
+        ptr->merged = true;
+        ptr->shared.fetch_add(std::exchange(ptr->local, 0) + reference::merged_flag, std::memory_order_acq_rel);
+    }
+    // then drop the reference the queue carried
+    intrusive_biased_release_shared(ptr, static_cast<T*>(ptr->derived));
+}
+
+} // namespace detail
+
+inline basic_intrusive_strong_reference<intrusive_refcount_biased>::basic_intrusive_strong_reference()
+    : owner{ detail::intrusive_biased_owner::acquire() }, local{ 1 }, merged{ false }, queued{ false }, shared{ 0 },
+      next_queued{ nullptr }, derived{ nullptr }, collect{ nullptr }
+{ }
+
+inline bool basic_intrusive_strong_reference<intrusive_refcount_biased>::owned_here() const noexcept
+{
+    return owner == detail::intrusive_biased_owner::current && !merged;
+}
+
+// Merges the objects other threads queued on this one, for owners that stop releasing references
+inline void intrusive_biased_collect() noexcept
+{
+    if (auto owner = detail::intrusive_biased_owner::current) {
+        owner->collect();
+    }
+}
+
+using intrusive_strong_reference = basic_intrusive_strong_reference<>;
+
+template<typename POLICY>
 inline
-void intrusive_strong_ptr_release(intrusive_strong_reference* ptr, T* derived)
+void intrusive_strong_ptr_add_ref(basic_intrusive_strong_reference<POLICY>* ptr)
 {
-    if (0 == --ptr->references) {
-        delete derived;
+    // a new reference is made from an existing one, nothing to order against
+    if constexpr (std::is_same_v<POLICY, intrusive_refcount_biased>) {
+        if (ptr->owned_here()) {
+            ptr->local++;
+        } else {
+            ptr->shared.fetch_add(1, std::memory_order_relaxed);
+        }
+    } else {
+        ptr->references.fetch_add(1, std::memory_order_relaxed);
     }
 }
 
+template<typename POLICY, typename T>
+inline
+void intrusive_strong_ptr_release(basic_intrusive_strong_reference<POLICY>* ptr, T* derived)
+{
+    // releases publish the owner's writes, whoever deletes acquires all of them
+    if constexpr (std::is_same_v<POLICY, intrusive_refcount_biased>) {
+        using reference = basic_intrusive_strong_reference<POLICY>;
+        if (ptr->owned_here()) {
+            auto owner = ptr->owner;
+            if (--ptr->local == 0) {
+                ptr->merged = true;
+                if (ptr->shared.fetch_add(reference::merged_flag, std::memory_order_acq_rel) == 0) {
+                    detail::intrusive_biased_destroy(ptr, derived);
+                }
+            }
+            owner->collect();
+        } else {
+            detail::intrusive_biased_release_remote(ptr, derived);
+        }
+    } else {
+        if (ptr->references.fetch_sub(1, std::memory_order_release) == 1) {
+            std::atomic_thread_fence(std::memory_order_acquire);
+            delete derived;
+        }
+    }
+}
+
+// Base giving DERIVED the intrusive_ptr API, counted according to POLICY
+template<typename DERIVED, typename POLICY = intrusive_refcount_atomic>
+class intrusive_ref_counted
+{
+public:
+    void intrusive_ptr_add_ref() noexcept
+    {
+        intrusive_strong_ptr_add_ref(&references_);
+    }
+
+    void intrusive_ptr_release() noexcept
+    {
+        intrusive_strong_ptr_release(&references_, static_cast<DERIVED*>(this));
+    }
+
+protected:
+    intrusive_ref_counted() noexcept = default;
+    ~intrusive_ref_counted() = default;
+
+    // a copy is a new object with its own count
+    intrusive_ref_counted(const intrusive_ref_counted&) noexcept {}
+    intrusive_ref_counted& operator=(const intrusive_ref_counted&) noexcept
+    {
+        return *this;
+    }
+
+private:
+    basic_intrusive_strong_reference<POLICY> references_;
+};
+
 
 union intrusive_weak_references {
     intrusive_weak_references() : references{ reference_count(1, 1) } { }
     
-    std::atomic<uint64_t> references;                   // both strong and weak
-    static inline uint32_t strong_count(uint64_t v)
+    std::atomic<uint64_t> references;                   // both strong and weak, the strong ones share a weak one
+    static constexpr uint32_t strong_count(uint64_t v)
     {
         return static_cast<uint32_t>(v);
     }
-    static inline uint32_t weak_count(uint64_t v)
+    static constexpr uint32_t weak_count(uint64_t v)
     {
         return static_cast<uint32_t>(v >> 32);
     }
-    static inline uint64_t reference_count(uint32_t strong, uint32_t weak)
+    static constexpr uint64_t reference_count(uint32_t strong, uint32_t weak)
     {
         return (static_cast<uint64_t>(weak) << 32) | strong;
     }
@@ -355,62 +634,73 @@ union intrusive_weak_references {
 inline
 void intrusive_weak_ptr_add_ref(intrusive_weak_references* ptr)
 {
-    ptr->references++;
+    ptr->references.fetch_add(intrusive_weak_references::reference_count(1, 0), std::memory_order_relaxed);
 }
 
-template<typename T>
+// Drops a weak reference, free_storage() runs with the last reference of any kind
+template<typename FREE>
 inline
-void intrusive_weak_ptr_release(intrusive_weak_references* ptr, T* derived)
+void intrusive_weak_ptr_release_weak(intrusive_weak_references* ptr, FREE&& free_storage)
 {
-    auto value = ptr->references.load();
-    decltype(value) desired;
+    constexpr auto one_weak = intrusive_weak_references::reference_count(0, 1);
+    if (ptr->references.fetch_sub(one_weak, std::memory_order_acq_rel) == one_weak) {
+        free_storage();
+    }
+}
 
-    do {
-        auto strong = intrusive_weak_references::strong_count(value) - 1;
-        auto weak = intrusive_weak_references::weak_count(value);
-        if (strong == 0)
-            weak--;
+// Drops a strong reference: derived is destroyed with the last strong one, free_storage() runs with
+// the last reference of any kind
+template<typename T, typename FREE>
+inline
+void intrusive_weak_ptr_release(intrusive_weak_references* ptr, T* derived, FREE&& free_storage)
+{
+    constexpr auto last = intrusive_weak_references::reference_count(1, 1);
+    constexpr auto dead = intrusive_weak_references::reference_count(0, 1);
 
-        desired = intrusive_weak_references::reference_count(strong, weak);
-    } while (!ptr->references.compare_exchange_weak(value, desired));
+    // the only reference and no weak ones: nobody else can reach the object
+    if (ptr->references.load(std::memory_order_acquire) == last) {
+        derived->~T();
+        free_storage();
+        return;
+    }
 
-    if (intrusive_weak_references::strong_count(desired) == 0) {
-        if (intrusive_weak_references::weak_count(desired) == 0) {
-            delete ptr;
-        } else {
-            derived->~T();
-        }
+    if (intrusive_weak_references::strong_count(
+            ptr->references.fetch_sub(intrusive_weak_references::reference_count(1, 0), std::memory_order_acq_rel)) != 1) {
+        return;
+    }
+    derived->~T();
+    // weak references cannot be made any more, only dropped
+    if (ptr->references.load(std::memory_order_acquire) == dead) {
+        free_storage();
+    } else {
+        intrusive_weak_ptr_release_weak(ptr, std::forward<FREE>(free_storage));
     }
 }
 
+// For counters that start the allocation of an object made with new
 inline
-void intrusive_weak_ptr_add_weak_ref(intrusive_weak_references* ptr)
+void intrusive_weak_ptr_release_weak(intrusive_weak_references* ptr)
 {
-    ptr->references += intrusive_weak_references::reference_count(0, 1);
+    intrusive_weak_ptr_release_weak(ptr, [ptr] { ::operator delete(ptr); });
 }
 
+template<typename T>
 inline
-void intrusive_weak_ptr_release_weak(intrusive_weak_references* ptr)
+void intrusive_weak_ptr_release(intrusive_weak_references* ptr, T* derived)
 {
-    auto value = ptr->references.load();
-    decltype(value) desired;
-
-    do {
-        auto strong = intrusive_weak_references::strong_count(value);
-        auto weak = intrusive_weak_references::weak_count(value) - 1;
-
-        desired = intrusive_weak_references::reference_count(strong, weak);
-    } while (!ptr->references.compare_exchange_weak(value, desired));
+    intrusive_weak_ptr_release(ptr, derived, [ptr] { ::operator delete(ptr); });
+}
 
-    if (desired == 0) {
-        ::operator delete(ptr);
-    }
+inline
+void intrusive_weak_ptr_add_weak_ref(intrusive_weak_references* ptr)
+{
+    ptr->references.fetch_add(intrusive_weak_references::reference_count(0, 1), std::memory_order_relaxed);
 }
 
 inline
 bool intrusive_weak_ptr_lock(intrusive_weak_references* ptr)
 {
-    auto value = ptr->references.load();
+    auto value = ptr->references.load(std::memory_order_relaxed);
     decltype(value) desired;
 
     do {
@@ -422,8 +712,155 @@ bool intrusive_weak_ptr_lock(intrusive_weak_references* ptr)
         }
 
         desired = intrusive_weak_references::reference_count(strong, weak);
-    } while (!ptr->references.compare_exchange_weak(value, desired));
+    } while (!ptr->references.compare_exchange_weak(value, desired, std::memory_order_acquire, std::memory_order_relaxed));
     return true;
 }
 
-}
\ No newline at end of file
+namespace detail {
+
+// Starts every allocation made by allocate_intrusive(), the object follows
+struct intrusive_control
+{
+    intrusive_weak_references references;
+    void (*deallocate)(intrusive_control*) noexcept;
+};
+
+constexpr size_t intrusive_round_up(size_t size, size_t alignment) noexcept
+{
+    return (size + alignment - 1) / alignment * alignment;
+}
+
+// Where the object sits does not depend on the allocator, the allocator copy goes after it
+template<typename T>
+constexpr size_t intrusive_object_offset = intrusive_round_up(sizeof(intrusive_control), alignof(T));
+
+template<typename T, typename ALLOC>
+struct intrusive_layout
+{
+    static constexpr size_t alignment = std::max({ alignof(intrusive_control), alignof(T), alignof(ALLOC) });
+    static constexpr size_t allocator_offset = intrusive_round_up(intrusive_object_offset<T> + sizeof(T), alignof(ALLOC));
+    static constexpr size_t size = intrusive_round_up(allocator_offset + sizeof(ALLOC), alignment);
+
+    struct alignas(alignment) chunk
+    {
+        unsigned char bytes[alignment];
+    };
+    using chunk_allocator = typename std::allocator_traits<ALLOC>::template rebind_alloc<chunk>;
+    using chunk_traits = std::allocator_traits<chunk_allocator>;
+    static constexpr size_t chunks = size / alignment;
+
+    static ALLOC* allocator_of(intrusive_control* control) noexcept
+    {
+        return reinterpret_cast<ALLOC*>(reinterpret_cast<char*>(control) + allocator_offset);
+    }
+
+    static void deallocate(intrusive_control* control) noexcept
+    {
+        auto allocator = allocator_of(control);
+        chunk_allocator chunk_alloc(std::move(*allocator));
+        allocator->~ALLOC();
+        control->~intrusive_control();
+        chunk_traits::deallocate(chunk_alloc, reinterpret_cast<chunk*>(control), chunks);
+    }
+};
+
+} // namespace detail
+
+/* Base for objects counted by a control block laid out in front of them, in the same allocation.
+ * Such objects support weak pointers and must be made by make_intrusive() or allocate_intrusive():
+ *
+ *   struct node : ptl::intrusive_weak_ref_counted<node> { ... };
+ *
+ *   auto n = ptl::make_intrusive<node>(...);
+ *   auto w = n.weak();
+ *
+ * The object is destroyed with its last strong reference, its memory goes back to the allocator
+ * with the last reference of any kind.
+ */
+template<typename DERIVED>
+class intrusive_weak_ref_counted
+{
+public:
+    void intrusive_ptr_add_ref() noexcept
+    {
+        intrusive_weak_ptr_add_ref(&control()->references);
+    }
+
+    void intrusive_ptr_release() noexcept
+    {
+        auto control = this->control();
+        intrusive_weak_ptr_release(&control->references, static_cast<DERIVED*>(this),
+                                   [control] { control->deallocate(control); });
+    }
+
+    void intrusive_wptr_add_ref() noexcept
+    {
+        intrusive_weak_ptr_add_weak_ref(&control()->references);
+    }
+
+    void intrusive_wptr_release() noexcept
+    {
+        auto control = this->control();
+        intrusive_weak_ptr_release_weak(&control->references, [control] { control->deallocate(control); });
+    }
+
+    bool intrusive_wptr_lock() noexcept
+    {
+        return intrusive_weak_ptr_lock(&control()->references);
+    }
+
+protected:
+    intrusive_weak_ref_counted() noexcept = default;
+    ~intrusive_weak_ref_counted() = default;
+
+    // a copy is a new object with its own count
+    intrusive_weak_ref_counted(const intrusive_weak_ref_counted&) noexcept {}
+    intrusive_weak_ref_counted& operator=(const intrusive_weak_ref_counted&) noexcept
+    {
+        return *this;
+    }
+
+private:
+    detail::intrusive_control* control() noexcept
+    {
+        return reinterpret_cast<detail::intrusive_control*>(
+            reinterpret_cast<char*>(static_cast<DERIVED*>(this)) - detail::intrusive_object_offset<DERIVED>);
+    }
+};
+
+// Makes T and its control block in one allocation from alloc, T must derive from intrusive_weak_ref_counted
+template<typename T, typename ALLOC, typename... ARGS>
+intrusive_ptr<T> allocate_intrusive(const ALLOC& alloc, ARGS&&... args)
+{
+    static_assert(std::is_base_of_v<intrusive_weak_ref_counted<T>, T>, "T must derive from intrusive_weak_ref_counted<T>");
+    using layout = detail::intrusive_layout<T, ALLOC>;
+
+    typename layout::chunk_allocator chunk_alloc(alloc);
+    auto storage = layout::chunk_traits::allocate(chunk_alloc, layout::chunks);
+    auto control = ::new (static_cast<void*>(storage)) detail::intrusive_control{ {}, &layout::deallocate };
+    auto raw = reinterpret_cast<char*>(control);
+
+    T* object;
+    try {
+        object = ::new (static_cast<void*>(raw + detail::intrusive_object_offset<T>)) T(std::forward<ARGS>(args)...);
+    } catch (...) {
+        control->~intrusive_control();
+        layout::chunk_traits::deallocate(chunk_alloc, storage, layout::chunks);
+        throw;
+    }
+    ::new (static_cast<void*>(layout::allocator_of(control))) ALLOC(std::move(chunk_alloc));
+    return intrusive_ptr<T>(object);
+}
+
+// Counted by a control block when T derives from intrusive_weak_ref_counted, plain new otherwise
+template<typename T, typename... ARGS>
+intrusive_ptr<T> make_intrusive(ARGS&&... args)
+{
+    if constexpr (std::is_base_of_v<intrusive_weak_ref_counted<T>, T>) {
+        return allocate_intrusive<T>(std::allocator<T>(), std::forward<ARGS>(args)...);
+    } else {
+        return intrusive_ptr<T>(new T(std::forward<ARGS>(args)...));
+    }
+}
+
+}
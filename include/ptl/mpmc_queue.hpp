@@ -1,4 +1,6 @@
 #pragma once
+#include <atomic>
+#include <vector>
 #include "ptl/aligned_allocator.hpp"
 
 namespace ptl {
@@ -8,17 +10,18 @@ enum class Lockless {
     MPMC,
 };
 
-template<typename T, Lockless KIND>
+template<typename T, Lockless KIND, typename ALLOC = aligned_allocator<T, Alignment::CACHE_LINE>>
 struct queue {};
 
-template<typename T>
-struct queue<T, Lockless::MPMC> {
+// ALLOC is rebound to the slots, give it cache line alignment
+template<typename T, typename ALLOC>
+struct queue<T, Lockless::MPMC, ALLOC> {
     static_assert(std::is_nothrow_copy_assignable_v<T> || std::is_nothrow_move_assignable_v<T>);
     static_assert(std::is_nothrow_destructible_v<T>);
 
 public:
-    explicit queue(const size_t capacity)
-        : slots_(capacity)
+    explicit queue(const size_t capacity, const ALLOC& alloc = ALLOC())
+        : slots_(capacity, slot_allocator(alloc))
     {
     }
     ~queue() noexcept = default;
@@ -45,7 +48,7 @@ public:
     bool try_emplace(Args&&... args) noexcept{
         static_assert(std::is_nothrow_constructible_v<T, Args&&...>);
 
-        const auto ticket = head_.load(std::memory_order_acquire);
+        auto ticket = head_.load(std::memory_order_acquire);
         for(;;) {
             auto& slot = slots_[idx(ticket)];
             if (acquire_turn(ticket) == slot.sequence_.load(std::memory_order_acquire)) {
@@ -79,13 +82,13 @@ public:
     bool try_push(const T& v) noexcept
     {
         static_assert(std::is_nothrow_copy_constructible_v<T>);
-        try_emplace(v);
+        return try_emplace(v);
     }
 
     template<typename P, typename = typename std::enable_if<std::is_nothrow_constructible_v<T, P&&>>::type>
     bool try_push(P&& v) noexcept
     {
-        try_emplace(std::forward<P>(v));
+        return try_emplace(std::forward<P>(v));
     }
 
     void pop(T& v) noexcept
@@ -172,7 +175,8 @@ private:
         }
     };
     static_assert(sizeof(slot) <= Alignment::CACHE_LINE, "Slot should really fit in a cache line");
-    std::vector<slot, aligned_allocator<slot, Alignment::CACHE_LINE>> slots_;
+    using slot_allocator = typename std::allocator_traits<ALLOC>::template rebind_alloc<slot>;
+    std::vector<slot, slot_allocator> slots_;
 
     alignas(Alignment::CACHE_LINE) std::atomic_size_t head_ = {0};
     alignas(Alignment::CACHE_LINE) std::atomic_size_t tail_ = {0};
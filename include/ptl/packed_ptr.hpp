@@ -2,6 +2,9 @@
 #include <type_traits>
 #include <cstdint>
 #include <atomic>
+#include <cstddef>
+#include <exception>
+#include <utility>
 
 namespace ptl {
 
@@ -245,6 +248,9 @@ private:
     uintptr_t data_;
 };
 
+/* The pointer takes the low 48 bits and the value (used as an ABA tag by lock-free structures) the
+ * high 16, so both change together in a single compare-exchange.
+ */
 template <typename T, typename VT = uint16_t>
 struct AtomicPackedPtr
 {
@@ -254,50 +260,99 @@ struct AtomicPackedPtr
         : data_(0)
     {}
 
-    VT value() const noexcept
+    VT value(std::memory_order order = std::memory_order_seq_cst) const noexcept
     {
-        return reinterpret_cast<VT>(data_.load() >> 48);
+        return value_of(data_.load(order));
     }
-    void set_value(VT v) noexcept
+    void set_value(VT v, std::memory_order order = std::memory_order_release) noexcept
     {
         uintptr_t expected, desired;
 
-        expected = data_.load();
+        expected = data_.load(std::memory_order_relaxed);
         do {
-            desired = ((uintptr_t)v << 48) | (expected & (-1ULL >> 16));
-        } while (!data_.compare_exchange_weak(expected, desired, std::memory_order_release));
+            desired = pack(pointer_of(expected), v);
+        } while (!data_.compare_exchange_weak(expected, desired, order, std::memory_order_relaxed));
     }
 
-    T *get() const noexcept
+    T *get(std::memory_order order = std::memory_order_seq_cst) const noexcept
     {
-        return reinterpret_cast<T *>(data_.load() & (-1ULL >> 16));
+        return pointer_of(data_.load(order));
     }
-    void set(T *ptr) noexcept
+    void set(T *ptr, std::memory_order order = std::memory_order_release) noexcept
     {
         uintptr_t expected, desired;
 
-        expected = data_.load();
+        expected = data_.load(std::memory_order_relaxed);
         do {
-            desired = (reinterpret_cast<uintptr_t>(ptr) & (-1ULL >> 16)) | (expected & (-1ULL << 48));
-        } while (!data_.compare_exchange_weak(expected, desired, std::memory_order_release));
+            desired = pack(ptr, value_of(expected));
+        } while (!data_.compare_exchange_weak(expected, desired, order, std::memory_order_relaxed));
     }
 
-    std::pair<T*, VT> get_add(VT delta) const noexcept
+    std::pair<T*, VT> load(std::memory_order order = std::memory_order_seq_cst) const noexcept
     {
-        uintptr_t expected, desired;
-        VT old;
+        auto data = data_.load(order);
+        return { pointer_of(data), value_of(data) };
+    }
+    void store(T *ptr, VT v, std::memory_order order = std::memory_order_seq_cst) noexcept
+    {
+        data_.store(pack(ptr, v), order);
+    }
 
-        expected = data_.load();
-        do {
-            old = expected >> 48;
-            VT new_value = old + delta;
-            desired = (expected & (-1ULL >> 16)) | (new_value << 48);
-        } while (!data_.compare_exchange_weak(expected, desired, std::memory_order_release));
-        return { reinterpret_cast<T *>(expected & (-1ULL >> 16)), old };
+    // Replaces pointer and value only if both match, otherwise loads them into the expected ones
+    bool compare_exchange_weak(T*& expected_ptr, VT& expected_value, T* desired_ptr, VT desired_value,
+                               std::memory_order success = std::memory_order_seq_cst,
+                               std::memory_order failure = std::memory_order_seq_cst) noexcept
+    {
+        auto expected = pack(expected_ptr, expected_value);
+        if (data_.compare_exchange_weak(expected, pack(desired_ptr, desired_value), success, failure)) {
+            return true;
+        }
+        expected_ptr = pointer_of(expected);
+        expected_value = value_of(expected);
+        return false;
+    }
+    bool compare_exchange_strong(T*& expected_ptr, VT& expected_value, T* desired_ptr, VT desired_value,
+                                 std::memory_order success = std::memory_order_seq_cst,
+                                 std::memory_order failure = std::memory_order_seq_cst) noexcept
+    {
+        auto expected = pack(expected_ptr, expected_value);
+        if (data_.compare_exchange_strong(expected, pack(desired_ptr, desired_value), success, failure)) {
+            return true;
+        }
+        expected_ptr = pointer_of(expected);
+        expected_value = value_of(expected);
+        return false;
+    }
+
+    // Adds delta to the value (wrapping), returns the previous pointer and value
+    std::pair<T*, VT> get_add(VT delta, std::memory_order order = std::memory_order_acq_rel) noexcept
+    {
+        // the value sits in the top bits, so a plain add wraps it without touching the pointer
+        auto old = data_.fetch_add(static_cast<uintptr_t>(delta) << value_shift, order);
+        return { pointer_of(old), value_of(old) };
+    }
+    std::pair<T*, VT> fetch_increment_tag(std::memory_order order = std::memory_order_acq_rel) noexcept
+    {
+        return get_add(1, order);
     }
 
 private:
-    using reference = typename std::add_lvalue_reference<T>::type;
+    static constexpr size_t value_shift = 48;
+    static constexpr uintptr_t ptr_mask = uintptr_t(-1) >> 16;
+
+    static T* pointer_of(uintptr_t data) noexcept
+    {
+        return reinterpret_cast<T *>(data & ptr_mask);
+    }
+    static VT value_of(uintptr_t data) noexcept
+    {
+        return static_cast<VT>(data >> value_shift);
+    }
+    static uintptr_t pack(T* ptr, VT v) noexcept
+    {
+        return (reinterpret_cast<uintptr_t>(ptr) & ptr_mask) | (static_cast<uintptr_t>(static_cast<uint16_t>(v)) << value_shift);
+    }
+
     std::atomic<uintptr_t> data_;
 };
 
@@ -0,0 +1,282 @@
+#pragma once
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include "ptl/aligned_allocator.hpp"
+
+namespace ptl {
+namespace detail {
+
+/* Size classes of 16 bytes up to 1 KiB.  Each thread keeps a free list per class and only goes to
+ * the shared pool, under the class' lock, to take or give back a batch.  Blocks are carved from
+ * 64 KiB slabs that are never returned: the pool lives as long as the process, threads may still
+ * free blocks during static destruction.  A block may be freed by another thread than the one that
+ * allocated it, it simply joins that thread's cache.
+ */
+class size_class_pool
+{
+public:
+    static constexpr size_t granularity = 16;
+    static constexpr size_t max_size = 1024;
+    static constexpr size_t classes = max_size / granularity;
+    static constexpr size_t slab_size = 64 * 1024;
+    static constexpr uint32_t batch = 32;
+    static constexpr uint32_t cache_limit = 2 * batch;
+
+    struct free_block
+    {
+        free_block* next;
+    };
+
+    struct thread_cache
+    {
+        free_block* lists[classes] = {};
+        uint32_t counts[classes] = {};
+    };
+
+    static size_class_pool& instance()
+    {
+        static size_class_pool* global = new size_class_pool;
+        return *global;
+    }
+
+    // nullptr once the thread is exiting
+    static thread_cache* this_thread() noexcept
+    {
+        if (current == nullptr && !exited) {
+            static thread_local exit_guard guard;
+            current = &guard.cache;
+        }
+        return current;
+    }
+
+    // Prepends a batch of blocks of the class to first, returns how many
+    uint32_t take(size_t index, free_block*& first)
+    {
+        std::scoped_lock lock(shared_[index].lock);
+        auto& list = shared_[index];
+        uint32_t taken = 0;
+        while (taken < batch && list.head != nullptr) {
+            auto b = list.head;
+            list.head = b->next;
+            b->next = first;
+            first = b;
+            taken++;
+        }
+        if (taken == 0) {
+            taken = carve(index, first);
+        }
+        return taken;
+    }
+
+    void give(size_t index, free_block* first, free_block* last) noexcept
+    {
+        std::scoped_lock lock(shared_[index].lock);
+        last->next = shared_[index].head;
+        shared_[index].head = first;
+    }
+
+private:
+    struct alignas(64) shared_list
+    {
+        std::mutex lock;
+        free_block* head = nullptr;
+    };
+
+    struct exit_guard
+    {
+        ~exit_guard()
+        {
+            auto& pool = instance();
+            for (size_t i = 0; i < classes; i++) {
+                if (auto first = cache.lists[i]) {
+                    auto last = first;
+                    while (last->next != nullptr) {
+                        last = last->next;
+                    }
+                    pool.give(i, first, last);
+                }
+            }
+            current = nullptr;
+            exited = true;
+        }
+
+        thread_cache cache;
+    };
+
+    static inline thread_local thread_cache* current = nullptr;
+    static inline thread_local bool exited = false;
+
+    // A batch of new blocks from the slab, a class size is a multiple of its blocks' alignment
+    uint32_t carve(size_t index, free_block*& first)
+    {
+        auto size = (index + 1) * granularity;
+        auto align = std::min<size_t>(size & (~size + 1), Alignment::CACHE_LINE);
+
+        std::scoped_lock lock(slab_lock_);
+        uint32_t carved = 0;
+        while (carved < batch) {
+            auto p = (slab_cursor_ + align - 1) & ~(align - 1);
+            if (p + size > slab_end_ || p < slab_cursor_) {
+                if (carved > 0) {
+                    break;
+                }
+                auto slab = allocate_aligned_memory(Alignment::CACHE_LINE, slab_size);
+                if (slab == nullptr) {
+                    throw std::bad_alloc();
+                }
+                slab_cursor_ = reinterpret_cast<uintptr_t>(slab);
+                slab_end_ = slab_cursor_ + slab_size;
+                continue;
+            }
+            slab_cursor_ = p + size;
+            first = new (reinterpret_cast<void*>(p)) free_block{ first };
+            carved++;
+        }
+        return carved;
+    }
+
+    shared_list shared_[classes];
+    std::mutex slab_lock_;
+    uintptr_t slab_cursor_ = 0;
+    uintptr_t slab_end_ = 0;
+};
+
+inline size_t pool_class_size(size_t size, size_t align) noexcept
+{
+    auto step = std::max(size_class_pool::granularity, align);
+    return (std::max<size_t>(size, 1) + step - 1) & ~(step - 1);
+}
+
+} // namespace detail
+
+// Memory from the per-thread size class pool, or from the heap beyond 1 KiB or 64 byte alignment
+inline void* pool_allocate(size_t size, size_t align = __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+{
+    using pool = detail::size_class_pool;
+
+    auto class_size = detail::pool_class_size(size, align);
+    if (class_size > pool::max_size || align > Alignment::CACHE_LINE) {
+        auto ptr = detail::allocate_aligned_memory(std::max(align, sizeof(void*)), size);
+        if (ptr == nullptr) {
+            throw std::bad_alloc();
+        }
+        return ptr;
+    }
+
+    auto index = class_size / pool::granularity - 1;
+    auto cache = pool::this_thread();
+    if (cache == nullptr) {
+        pool::free_block* first = nullptr;
+        auto taken = pool::instance().take(index, first);
+        if (taken > 1) {
+            auto rest = first->next;
+            auto last = rest;
+            while (last->next != nullptr) {
+                last = last->next;
+            }
+            pool::instance().give(index, rest, last);
+        }
+        return first;
+    }
+
+    if (cache->lists[index] == nullptr) {
+        cache->counts[index] += pool::instance().take(index, cache->lists[index]);
+    }
+    auto block = cache->lists[index];
+    cache->lists[index] = block->next;
+    cache->counts[index]--;
+    return block;
+}
+
+// size and align as given to pool_allocate()
+inline void pool_deallocate(void* ptr, size_t size, size_t align = __STDCPP_DEFAULT_NEW_ALIGNMENT__) noexcept
+{
+    using pool = detail::size_class_pool;
+
+    auto class_size = detail::pool_class_size(size, align);
+    if (class_size > pool::max_size || align > Alignment::CACHE_LINE) {
+        detail::deallocate_aligned_memory(ptr);
+        return;
+    }
+
+    auto index = class_size / pool::granularity - 1;
+    auto block = new (ptr) pool::free_block{ nullptr };
+    auto cache = pool::this_thread();
+    if (cache == nullptr) {
+        pool::instance().give(index, block, block);
+        return;
+    }
+
+    block->next = cache->lists[index];
+    cache->lists[index] = block;
+    if (++cache->counts[index] > pool::cache_limit) {
+        // keep a batch, hand the rest back
+        auto last = block;
+        for (uint32_t i = 1; i < pool::batch; i++) {
+            last = last->next;
+        }
+        auto rest = last->next;
+        last->next = nullptr;
+        auto tail = rest;
+        while (tail->next != nullptr) {
+            tail = tail->next;
+        }
+        pool::instance().give(index, rest, tail);
+        cache->counts[index] = pool::batch;
+    }
+}
+
+/* Standard allocator over the size class pool, aligned to at least A like aligned_allocator.
+ * Stateless, every pool_allocator can free what another one allocated.
+ */
+template <typename T, size_t A = alignof(T)>
+class pool_allocator
+{
+public:
+    using value_type = T;
+    using size_type = size_t;
+    using difference_type = ptrdiff_t;
+
+    using propagate_on_container_move_assignment = std::true_type;
+    using is_always_equal = std::true_type;
+
+    template <typename U>
+    struct rebind {
+        using other = pool_allocator<U, A>;
+    };
+
+    constexpr pool_allocator() noexcept {}
+    template <typename U>
+    constexpr pool_allocator(const pool_allocator<U, A>&) noexcept
+    {}
+
+    [[nodiscard]] T* allocate(size_type n)
+    {
+        return static_cast<T*>(pool_allocate(n * sizeof(T), alignment));
+    }
+    void deallocate(T* p, size_type n) noexcept
+    {
+        pool_deallocate(p, n * sizeof(T), alignment);
+    }
+
+    template <typename U>
+    constexpr bool operator==(const pool_allocator<U, A>&) const noexcept
+    {
+        return true;
+    }
+    template <typename U>
+    constexpr bool operator!=(const pool_allocator<U, A>&) const noexcept
+    {
+        return false;
+    }
+
+private:
+    static constexpr size_type alignment = A > alignof(T) ? A : alignof(T);
+};
+
+}
@@ -25,20 +25,25 @@ namespace ptl::sync {
 namespace detail {
 
 // Platform sepcific
+// state_ is 0 (not set), 1 (set) or 2 (not set and someone may sleep on it), so set() only makes
+// the futex syscall when there is a sleeper, and wait() spins a little before sleeping: an event
+// that is set shortly after wait() never goes through the kernel.
 class linux_manual_reset_event
 {
 public:
+    static constexpr int spin_count = 128;
+
     linux_manual_reset_event()
         : state_(0)
     {}
 
     void set()
     {
-        state_.store(1, std::memory_order_release);
-
-        [[maybe_unused]] int count_awaken =
-            local::futex(reinterpret_cast<int *>(&state_), FUTEX_WAKE_PRIVATE, INT32_MAX, nullptr, nullptr, 0);
-        assert(count_awaken >= 0);
+        if (state_.exchange(1, std::memory_order_release) == 2) {
+            [[maybe_unused]] int count_awaken =
+                local::futex(reinterpret_cast<int *>(&state_), FUTEX_WAKE_PRIVATE, INT32_MAX, nullptr, nullptr, 0);
+            assert(count_awaken >= 0);
+        }
     }
 
     void reset()
@@ -46,14 +51,26 @@ public:
         state_.store(0, std::memory_order_relaxed);
     }
 
+    bool is_set() const
+    {
+        return state_.load(std::memory_order_acquire) == 1;
+    }
+
     void wait()
     {
-        int old = state_.load(std::memory_order_acquire);
-        while (old == 0) {
-            int result = local::futex(reinterpret_cast<int *>(&state_), FUTEX_WAIT_PRIVATE, old, nullptr, nullptr, 0);
-            if (result == -1 and errno == EAGAIN) {
+        for (int i = 0; i < spin_count; i++) {
+            if (is_set()) {
                 return;
             }
+#if defined(__x86_64__) || defined(__i386__)
+            __builtin_ia32_pause();
+#endif
+        }
+
+        int old = 0;
+        state_.compare_exchange_strong(old, 2, std::memory_order_acquire);
+        while (old != 1) {
+            local::futex(reinterpret_cast<int *>(&state_), FUTEX_WAIT_PRIVATE, 2, nullptr, nullptr, 0);
             old = state_.load(std::memory_order_acquire);
         }
     }
@@ -72,6 +89,7 @@ public:
     using detail::platform_manual_reset_event::set;
     using detail::platform_manual_reset_event::reset;
     using detail::platform_manual_reset_event::wait;
+    using detail::platform_manual_reset_event::is_set;
 };
 
 } // namespace ptl::sync
\ No newline at end of file
@@ -1,4 +1,6 @@
 #pragma once
+#include <mutex>
+#include <utility>
 
 namespace ptl {
 
@@ -8,11 +10,12 @@ struct null_lock {
 };
 
 
+// Runs lambda under lock and returns what it returns
 template <typename LOCK, typename LAMBDA>
-void synchronize(LOCK& lock, LAMBDA lambda)
+decltype(auto) synchronize(LOCK& lock, LAMBDA&& lambda)
 {
     std::scoped_lock sl(lock);
-    lambda();
+    return std::forward<LAMBDA>(lambda)();
 }
 
 }
\ No newline at end of file
@@ -1,61 +1,98 @@
 #include "ptl/experimental/coroutine/io_service/io_service.hpp"
+#include "ptl/scope_guard.hpp"
 #include <cassert>
 #include <system_error>
 #include <mutex>
+#include <utility>
 
 #include <unistd.h>
 #include <fcntl.h>
+#include <signal.h>
 #include <sys/types.h>
 #include <sys/socket.h>
+#include <sys/syscall.h>
 #include <sys/un.h>
+#include <sys/wait.h>
 
 namespace ptl::experimental::coroutine::iosvc::detail {
 
 std::mutex libev_guard_;
 
-io_service_impl::io_service_impl()
+namespace {
+
+int pidfd_open(int pid) noexcept
 {
-    static std::atomic<int> count__ = 0;
+#if defined(SYS_pidfd_open)
+    return static_cast<int>(::syscall(SYS_pidfd_open, pid, 0));
+#else
+    errno = ENOSYS;
+    return -1;
+#endif
+}
 
-    process_monitor_ = std::make_unique<ev_child>();
-    ev_child_init(process_monitor_.get(), ev_process_change, 0, 0);
+} // namespace
 
-    struct ev_loop* loop;
-    if (count__++ == 0) {
-        loop = ev_default_loop();
-    }
-    else {
-        loop = ev_loop_new(0);
-    }
+io_service_impl::io_service_impl()
+{
+    // Never use the default loop: libev installs a SIGCHLD handler there that reaps every child
+    // with waitpid(-1), which would steal the exit status from the per-process pidfd watchers.
+    struct ev_loop* loop = ev_loop_new(EVFLAG_AUTO);
     if (loop == nullptr) {
         throw std::bad_alloc();
     }
     ev_set_userdata(loop, static_cast<void*>(this));
 
+    // the wakeup watcher keeps the loop blocked in the kernel when there is nothing else to do,
+    // it is started right away so work posted before run() is not lost
+    wakeup_ = std::make_unique<ev_async>();
+    ev_async_init(wakeup_.get(), ev_wakeup);
+    ev_async_start(loop, wakeup_.get());
+
     running_ = true;
     event_loop_ = loop;
 }
 
 io_service_impl::~io_service_impl()
 {
+    if (process_monitor_) {
+        ev_signal_stop(event_loop_, process_monitor_.get());
+    }
+    ev_async_stop(event_loop_, wakeup_.get());
     ev_loop_destroy(event_loop_);
 }
 
 void io_service_impl::stop() noexcept
 {
     running_ = false;
-    ev_break(event_loop_, EVBREAK_ALL);
-    ev_child_stop(event_loop_, process_monitor_.get());
+    ev_async_send(event_loop_, wakeup_.get());
 }
 
 void io_service_impl::run()
 {
-    ev_child_start(event_loop_, process_monitor_.get());
+    auto previous = std::exchange(current, this);
+    SCOPE_EXIT({ current = previous; });
+
     while (running_) {
         ev_run(event_loop_, EVRUN_ONCE);
     }
 }
 
+void io_service_impl::post(execution::work_item& item) noexcept
+{
+    if (posted_.push(item)) {
+        ev_async_send(event_loop_, wakeup_.get());
+    }
+}
+
+void io_service_impl::ev_wakeup(struct ev_loop* loop, ev_async* async, int events)
+{
+    auto& self = *static_cast<io_service_impl*>(ev_userdata(loop));
+    self.posted_.run();
+    if (!self.running_) {
+        ev_break(loop, EVBREAK_ALL);
+    }
+}
+
 std::unique_ptr<detail::descriptor_service_data> io_service_impl::register_descriptor(descriptor fd)
 {
     auto data = std::make_unique<descriptor_service_data>(fd);
@@ -69,14 +106,45 @@ void io_service_impl::deregister_descriptor(descriptor fd, std::unique_ptr<detai
     ev_io_stop(event_loop_, &data->ev_);
 }
 
-void io_service_impl::register_process_notification(int pid, process_service_data& data)
+expected_void io_service_impl::register_process_notification(int pid, process_service_data& data)
 {
     data.pid = pid;
+    data.rc = 0;
+    data.exited = false;
+    data.notification = nullptr;
+
+    // Watch the child from the moment it is registered so that an exit status is never lost,
+    // even if nobody is waiting on the process yet.
+    data.pidfd = pidfd_open(pid);
+    if (data.pidfd >= 0) {
+        ev_io_init(&data.ev_, ev_process_exit, data.pidfd, EV_READ);
+        ev_io_start(event_loop_, &data.ev_);
+        return {};
+    }
+
+    // pidfd_open can fail for many reasons: old kernel, seccomp, out of descriptors.  The child is
+    // running either way and must be reaped, so fall back to SIGCHLD instead of failing.
+    if (!process_monitor_) {
+        process_monitor_ = std::make_unique<ev_signal>();
+        ev_signal_init(process_monitor_.get(), ev_process_change, SIGCHLD);
+        ev_signal_start(event_loop_, process_monitor_.get());
+    }
+    process_watchers_.insert_or_assign(pid, std::ref(data));
+    // the child may have exited before the watcher started, its SIGCHLD is gone then
+    reap_watched(data);
+    return {};
 }
 
 void io_service_impl::deregister_process_notification(process_service_data& data)
 {
     stop_notification(data);
+    if (data.pidfd >= 0) {
+        ev_io_stop(event_loop_, &data.ev_);
+        ::close(data.pidfd);
+        data.pidfd = -1;
+    } else if (data.pid != 0) {
+        process_watchers_.erase(data.pid);
+    }
 }
 
 void io_service_impl::start_io(detail::descriptor_service_data& data, io_kind kind, io_service_operation* op)
@@ -84,9 +152,12 @@ void io_service_impl::start_io(detail::descriptor_service_data& data, io_kind ki
     data.current_io_ = kind;
     data.current_op_ = op;
 
-    if (kind == io_kind::write && (data.registered_events_ & EV_WRITE) == 0) {
-        ev_io_set(&data.ev_, data.descriptor_.native_descriptor(), EV_READ | EV_WRITE);
-        data.registered_events_ |= EV_WRITE;
+    // only watch for what the operation waits on, a writable socket would otherwise wake a reader
+    int events = kind == io_kind::write ? EV_WRITE : EV_READ;
+    if (data.registered_events_ != events) {
+        ev_io_stop(event_loop_, &data.ev_);
+        ev_io_set(&data.ev_, data.descriptor_.native_descriptor(), events);
+        data.registered_events_ = events;
     }
     ev_io_start(event_loop_, &data.ev_);
 }
@@ -101,26 +172,73 @@ void io_service_impl::stop_io(descriptor_service_data& data)
 void io_service_impl::start_notification(detail::process_service_data &data, io_service_operation *op)
 {
     data.notification = op;
-    process_watchers_.push_back(data);
 }
 
 void io_service_impl::stop_notification(detail::process_service_data &data)
 {
-    // reference_wrapper does not implement equality
-    process_watchers_.remove_if([&](auto l){
-        return &l.get() == &data;
-    });
+    data.notification = nullptr;
+}
+
+void io_service_impl::process_exited(process_service_data& data, int status)
+{
+    data.rc = status;
+    data.exited = true;
+    if (auto op = std::exchange(data.notification, nullptr)) {
+        execution::cooperative_budget::refill();
+        op->work();
+    }
 }
 
-void io_service_impl::ev_process_change(struct ev_loop* loop, struct ev_child* child, int events)
+void io_service_impl::ev_process_exit(struct ev_loop* loop, ev_io* io, int events)
 {
+    process_service_data& data = *container_of(io, &process_service_data::ev_);
+
+    int status;
+    int r = ::waitpid(data.pid, &status, WNOHANG);
+    if (r == 0 || (r < 0 && errno == EINTR)) {
+        // spurious wakeup, the pidfd stays readable until the child is reaped
+        return;
+    }
+
+    ev_io_stop(loop, io);
+    ::close(data.pidfd);
+    data.pidfd = -1;
+
     auto self = static_cast<io_service_impl*>(ev_userdata(loop));
-    for (auto i : self->process_watchers_)
-    {
-        if (i.get().pid == child->rpid) {
-            i.get().rc = child->rstatus;
-            i.get().notification->work();
-            break;
+    self->process_exited(data, r < 0 ? -1 : status);
+}
+
+// Reaps a child watched through SIGCHLD if it has exited, true when it has
+bool io_service_impl::reap_watched(process_service_data& data)
+{
+    int status;
+    int r;
+    do {
+        r = ::waitpid(data.pid, &status, WNOHANG);
+    } while (r < 0 && errno == EINTR);
+    if (r == 0) {
+        return false;
+    }
+
+    process_watchers_.erase(data.pid);
+    process_exited(data, r < 0 ? -1 : status);
+    return true;
+}
+
+void io_service_impl::ev_process_change(struct ev_loop* loop, struct ev_signal* signal, int events)
+{
+    auto self = static_cast<io_service_impl*>(ev_userdata(loop));
+
+    // SIGCHLD coalesces and also comes for children watched through a pidfd or not ours at all:
+    // only reap the registered ones.  A completion may deregister others, start over after each.
+    bool reaped = true;
+    while (reaped) {
+        reaped = false;
+        for (auto& [pid, data] : self->process_watchers_) {
+            if (self->reap_watched(data.get())) {
+                reaped = true;
+                break;
+            }
         }
     }
 }
@@ -128,9 +246,17 @@ void io_service_impl::ev_process_change(struct ev_loop* loop, struct ev_child* c
 void io_service_impl::ev_notification(struct ev_loop* loop, ev_io* io, int events)
 {
     descriptor_service_data& data = *container_of(io, &descriptor_service_data::ev_);
-    if ((events & (int)data.current_io_) == (int)data.current_io_) {
-        data.current_op_->work();
+    if (data.current_op_ == nullptr || (events & (int)data.current_io_) != (int)data.current_io_) {
+        return;
     }
+    // Notifications are one shot: the operation is done with the watcher once it runs, and the
+    // next operation on the descriptor may well complete without it.  Left armed, a level
+    // triggered watcher would hand that operation's data to the finished one.
+    auto op = std::exchange(data.current_op_, nullptr);
+    data.current_io_ = io_kind::none;
+    ev_io_stop(loop, io);
+    execution::cooperative_budget::refill();
+    op->work();
 }
 
 std::pair<descriptor::native_type, descriptor::native_type> io_service_impl::create_pair()
@@ -28,7 +28,7 @@ iosvc::detail::expected_void socket_internal::bind(const ip_endpoint& ep)
     if (local_.is_ipv4()) {
         const auto& ep4 = local_.to_ipv4();
 
-        ::sockaddr_storage storage;
+        ::sockaddr_storage storage{};
         ::sockaddr_in* addr = reinterpret_cast<::sockaddr_in*>(&storage);
 
         addr->sin_family = AF_INET;
@@ -39,24 +39,20 @@ iosvc::detail::expected_void socket_internal::bind(const ip_endpoint& ep)
     } else {
         const auto& ep6 = local_.to_ipv6();
 
-        ::sockaddr_storage storage;
+        ::sockaddr_storage storage{};
         ::sockaddr_in6* addr = reinterpret_cast<::sockaddr_in6*>(&storage);
 
         addr->sin6_family = AF_INET6;
-        std::memcpy(&addr->sin6_addr, ep6.address().bytes().data(), 4);
+        std::memcpy(&addr->sin6_addr, ep6.address().bytes().data(), 16);
         addr->sin6_port = ::htons(ep6.port());
 
-        return service_.bind(native_descriptor(), addr, sizeof(::sockaddr_in));
+        return service_.bind(native_descriptor(), addr, sizeof(::sockaddr_in6));
     }
 }
 
 iosvc::detail::expected_void socket_internal::listen()
 {
-    auto r = service_.listen(native_descriptor(), 0);
-    if (r.is_error()) {
-        return r;
-    }
-    return get_local();
+    return service_.listen(native_descriptor(), 0).and_then([this] { return get_local(); });
 }
 
 iosvc::detail::expected_void socket_internal::connect(const ip_endpoint& ep)
@@ -64,7 +60,7 @@ iosvc::detail::expected_void socket_internal::connect(const ip_endpoint& ep)
     if (ep.is_ipv4()) {
         const auto& ep4 = ep.to_ipv4();
 
-        ::sockaddr_storage storage;
+        ::sockaddr_storage storage{};
         ::sockaddr_in* addr = reinterpret_cast<::sockaddr_in*>(&storage);
 
         addr->sin_family = AF_INET;
@@ -75,14 +71,14 @@ iosvc::detail::expected_void socket_internal::connect(const ip_endpoint& ep)
     } else {
         const auto& ep6 = ep.to_ipv6();
 
-        ::sockaddr_storage storage;
+        ::sockaddr_storage storage{};
         ::sockaddr_in6* addr = reinterpret_cast<::sockaddr_in6*>(&storage);
 
         addr->sin6_family = AF_INET6;
-        std::memcpy(&addr->sin6_addr, ep6.address().bytes().data(), 4);
+        std::memcpy(&addr->sin6_addr, ep6.address().bytes().data(), 16);
         addr->sin6_port = ::htons(ep6.port());
 
-        return service_.connect(native_descriptor(), addr, sizeof(::sockaddr_in));
+        return service_.connect(native_descriptor(), addr, sizeof(::sockaddr_in6));
     }
 }
 
@@ -93,25 +89,19 @@ iosvc::detail::expected_socket socket_internal::accept()
         ::sockaddr_in* addr = reinterpret_cast<::sockaddr_in*>(&storage);
         size_t len = sizeof(*addr);
 
-        auto r = service_.accept(native_descriptor(), addr, &len);
-        if (r.is_error()) {
-            return r;
-        }
-
-        remote_ = ipv4_endpoint(ipv4_address(addr->sin_addr.s_addr), ntohs(addr->sin_port));
-        return r;
+        return service_.accept(native_descriptor(), addr, &len).transform([&](auto s) {
+            remote_ = ipv4_endpoint(ipv4_address(addr->sin_addr.s_addr), ntohs(addr->sin_port));
+            return s;
+        });
     } else {
         ::sockaddr_storage storage;
         ::sockaddr_in6* addr = reinterpret_cast<::sockaddr_in6*>(&storage);
         size_t len = sizeof(*addr);
 
-        auto r = service_.accept(native_descriptor(), addr, &len);
-        if (r.is_error()) {
-            return r;
-        }
-
-        remote_ = ipv6_endpoint(ipv6_address(addr->sin6_addr.s6_addr), ntohs(addr->sin6_port));
-        return r;
+        return service_.accept(native_descriptor(), addr, &len).transform([&](auto s) {
+            remote_ = ipv6_endpoint(ipv6_address(addr->sin6_addr.s6_addr), ntohs(addr->sin6_port));
+            return s;
+        });
     }
 }
 
@@ -127,10 +117,7 @@ iosvc::detail::expected_void socket_internal::get_local()
         ::sockaddr_in* addr = reinterpret_cast<::sockaddr_in*>(&storage);
         size_t len = sizeof(*addr);
 
-        auto r = service_.getsockname(native_descriptor(), addr, &len);
-        if (r.is_error()) {
-            return r;
-        }
+        PTL_TRY(service_.getsockname(native_descriptor(), addr, &len));
 
         local_ = ipv4_endpoint(ipv4_address(ntohl(addr->sin_addr.s_addr)), ntohs(addr->sin_port));
     } else {
@@ -138,10 +125,7 @@ iosvc::detail::expected_void socket_internal::get_local()
         ::sockaddr_in6* addr = reinterpret_cast<::sockaddr_in6*>(&storage);
         size_t len = sizeof(*addr);
 
-        auto r = service_.getsockname(native_descriptor(), addr, &len);
-        if (r.is_error()) {
-            return r;
-        }
+        PTL_TRY(service_.getsockname(native_descriptor(), addr, &len));
 
         local_ = ipv6_endpoint(ipv6_address(addr->sin6_addr.s6_addr), ntohs(addr->sin6_port));
     }
@@ -155,10 +139,7 @@ iosvc::detail::expected_void socket_internal::get_remote()
         ::sockaddr_in* addr = reinterpret_cast<::sockaddr_in*>(&storage);
         size_t len = sizeof(*addr);
 
-        auto r = service_.getpeername(native_descriptor(), addr, &len);
-        if (r.is_error()) {
-            return r;
-        }
+        PTL_TRY(service_.getpeername(native_descriptor(), addr, &len));
 
         remote_ = ipv4_endpoint(ipv4_address(ntohl(addr->sin_addr.s_addr)), ntohs(addr->sin_port));
     } else {
@@ -166,10 +147,7 @@ iosvc::detail::expected_void socket_internal::get_remote()
         ::sockaddr_in6* addr = reinterpret_cast<::sockaddr_in6*>(&storage);
         size_t len = sizeof(*addr);
 
-        auto r = service_.getpeername(native_descriptor(), addr, &len);
-        if (r.is_error()) {
-            return r;
-        }
+        PTL_TRY(service_.getpeername(native_descriptor(), addr, &len));
 
         remote_ = ipv6_endpoint(ipv6_address(addr->sin6_addr.s6_addr), ntohs(addr->sin6_port));
     }
@@ -0,0 +1,245 @@
+#include "catch2/catch.hpp"
+#include "ptl/aligned_allocator.hpp"
+#include "ptl/arena.hpp"
+#include "ptl/containers/list.hpp"
+#include "ptl/mpmc_queue.hpp"
+#include "ptl/pool_allocator.hpp"
+
+#include <list>
+#include <memory>
+#include <set>
+#include <thread>
+#include <vector>
+
+struct arena_node
+{
+    explicit arena_node(int v)
+        : value(v)
+    {}
+
+    int value;
+    ptl::ListEntry<LIST_BINDING(arena_node, entry)> entry;
+};
+MAKE_LIST_BINDING(arena_node, entry);
+
+namespace {
+
+template <typename T>
+bool aligned(T* ptr, size_t alignment)
+{
+    return reinterpret_cast<uintptr_t>(ptr) % alignment == 0;
+}
+
+} // namespace
+
+TEST_CASE("monotonic arena")
+{
+    SECTION("bumps and aligns")
+    {
+        ptl::monotonic_arena arena(1024);
+        auto a = static_cast<char*>(arena.allocate(3, 1));
+        auto b = static_cast<char*>(arena.allocate(8, 8));
+        auto c = arena.allocate(64, 64);
+        REQUIRE(b >= a + 3);
+        REQUIRE(aligned(b, 8));
+        REQUIRE(aligned(c, 64));
+    }
+    SECTION("grows past a block and reuses the newest one")
+    {
+        ptl::monotonic_arena arena(256);
+        std::set<void*> first_round;
+        for (int i = 0; i < 100; i++) {
+            first_round.insert(arena.allocate(100));
+        }
+        REQUIRE(first_round.size() == 100);
+
+        arena.reset();
+        auto again = arena.allocate(100);
+        auto more = arena.allocate(100);
+        REQUIRE(first_round.count(again) == 1);
+        REQUIRE(first_round.count(more) == 1);
+
+        // bigger than any block
+        REQUIRE(arena.allocate(1 << 21) != nullptr);
+    }
+    SECTION("starts in a caller buffer")
+    {
+        alignas(64) char buffer[256];
+        ptl::monotonic_arena arena(buffer, sizeof(buffer));
+        auto p = static_cast<char*>(arena.allocate(200));
+        REQUIRE(p >= buffer);
+        REQUIRE(p + 200 <= buffer + sizeof(buffer));
+        auto q = static_cast<char*>(arena.allocate(200));
+        REQUIRE((q < buffer || q >= buffer + sizeof(buffer)));
+        arena.reset();
+    }
+    SECTION("standard containers")
+    {
+        ptl::monotonic_arena arena;
+        std::vector<int, ptl::arena_allocator<int>> numbers(arena);
+        for (int i = 0; i < 1000; i++) {
+            numbers.push_back(i);
+        }
+        REQUIRE(numbers[999] == 999);
+
+        std::list<int, ptl::arena_allocator<int>> list(arena);
+        list.push_back(1);
+        list.push_back(2);
+        REQUIRE(list.back() == 2);
+
+        std::vector<char, ptl::arena_allocator<char, ptl::Alignment::CACHE_LINE>> cached(3, 'x', arena);
+        REQUIRE(aligned(cached.data(), ptl::Alignment::CACHE_LINE));
+        REQUIRE(cached.get_allocator() == ptl::arena_allocator<char, ptl::Alignment::CACHE_LINE>(arena));
+    }
+    SECTION("intrusive lists")
+    {
+        ptl::monotonic_arena arena;
+        {
+            // destroys the nodes it still holds, the arena frees them
+            ptl::List<LIST_BINDING(arena_node, entry), ptl::list_destroy> list;
+            for (int i = 0; i < 10; i++) {
+                list.push_back(arena.make<arena_node>(i));
+            }
+            REQUIRE(list.front()->value == 0);
+            REQUIRE(list.back()->value == 9);
+        }
+        arena.reset();
+    }
+    SECTION("mpmc queue")
+    {
+        ptl::monotonic_arena arena;
+        using allocator = ptl::arena_allocator<int, ptl::Alignment::CACHE_LINE>;
+        ptl::queue<int, ptl::Lockless::MPMC, allocator> queue(8, allocator(arena));
+        REQUIRE(queue.try_emplace(4));
+        int v = 0;
+        REQUIRE(queue.try_pop(v));
+        REQUIRE(v == 4);
+    }
+}
+
+TEST_CASE("pool allocator")
+{
+    SECTION("recycles by size class")
+    {
+        auto a = ptl::pool_allocate(40);
+        ptl::pool_deallocate(a, 40);
+        auto b = ptl::pool_allocate(48);
+        REQUIRE(a == b);
+        ptl::pool_deallocate(b, 48);
+    }
+    SECTION("alignment")
+    {
+        std::vector<void*> blocks;
+        for (int i = 0; i < 100; i++) {
+            blocks.push_back(ptl::pool_allocate(16, 16));
+            blocks.push_back(ptl::pool_allocate(64, 64));
+            blocks.push_back(ptl::pool_allocate(4000, 128));
+            REQUIRE(aligned(blocks[blocks.size() - 3], 16));
+            REQUIRE(aligned(blocks[blocks.size() - 2], 64));
+            REQUIRE(aligned(blocks[blocks.size() - 1], 128));
+        }
+        for (size_t i = 0; i < blocks.size(); i += 3) {
+            ptl::pool_deallocate(blocks[i], 16, 16);
+            ptl::pool_deallocate(blocks[i + 1], 64, 64);
+            ptl::pool_deallocate(blocks[i + 2], 4000, 128);
+        }
+    }
+    SECTION("standard containers")
+    {
+        std::list<int, ptl::pool_allocator<int>> numbers;
+        for (int i = 0; i < 1000; i++) {
+            numbers.push_back(i);
+        }
+        REQUIRE(numbers.size() == 1000);
+        std::vector<double, ptl::pool_allocator<double, ptl::Alignment::AVX>> avx(10);
+        REQUIRE(aligned(avx.data(), ptl::Alignment::AVX));
+    }
+    SECTION("freed by other threads")
+    {
+        constexpr int count = 10000;
+        std::vector<int*> blocks;
+        for (int i = 0; i < count; i++) {
+            blocks.push_back(static_cast<int*>(ptl::pool_allocate(sizeof(int) * 8)));
+            *blocks.back() = i;
+        }
+        std::thread([&] {
+            for (auto b : blocks) {
+                ptl::pool_deallocate(b, sizeof(int) * 8);
+            }
+        }).join();
+
+        std::set<void*> distinct;
+        for (int i = 0; i < count; i++) {
+            distinct.insert(ptl::pool_allocate(sizeof(int) * 8));
+        }
+        REQUIRE(distinct.size() == count);
+        for (auto b : distinct) {
+            ptl::pool_deallocate(b, sizeof(int) * 8);
+        }
+    }
+}
+
+TEST_CASE("allocators benchmark", "[.][benchmark]")
+{
+    constexpr int count = 1000;
+
+    auto churn = [](auto allocate, auto deallocate) {
+        void* blocks[count];
+        for (int i = 0; i < count; i++) {
+            blocks[i] = allocate(64 + (i & 3) * 16);
+        }
+        for (int i = 0; i < count; i++) {
+            deallocate(blocks[i], 64 + (i & 3) * 16);
+        }
+        return blocks[count - 1];
+    };
+
+    BENCHMARK("operator new") {
+        return churn([](size_t sz) { return ::operator new(sz); }, [](void* p, size_t) { ::operator delete(p); });
+    };
+
+    BENCHMARK("aligned_allocator") {
+        return churn([](size_t sz) { return ptl::detail::allocate_aligned_memory(16, sz); },
+                     [](void* p, size_t) { ptl::detail::deallocate_aligned_memory(p); });
+    };
+
+    ptl::monotonic_arena arena;
+    BENCHMARK("monotonic_arena, reset per round") {
+        auto last = churn([&](size_t sz) { return arena.allocate(sz); }, [](void*, size_t) {});
+        arena.reset();
+        return last;
+    };
+
+    BENCHMARK("pool_allocator") {
+        return churn([](size_t sz) { return ptl::pool_allocate(sz); }, [](void* p, size_t sz) { ptl::pool_deallocate(p, sz); });
+    };
+
+    BENCHMARK("std::list<int>, std::allocator") {
+        std::list<int> l;
+        for (int i = 0; i < count; i++) {
+            l.push_back(i);
+        }
+        return l.size();
+    };
+
+    BENCHMARK("std::list<int>, arena_allocator") {
+        size_t size;
+        {
+            std::list<int, ptl::arena_allocator<int>> l(arena);
+            for (int i = 0; i < count; i++) {
+                l.push_back(i);
+            }
+            size = l.size();
+        }
+        arena.reset();
+        return size;
+    };
+
+    BENCHMARK("std::list<int>, pool_allocator") {
+        std::list<int, ptl::pool_allocator<int>> l;
+        for (int i = 0; i < count; i++) {
+            l.push_back(i);
+        }
+        return l.size();
+    };
+}
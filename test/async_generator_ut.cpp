@@ -0,0 +1,139 @@
+#include "catch2/catch.hpp"
+#include <string>
+#include <vector>
+#include "ptl/experimental/coroutine/task.hpp"
+#include "ptl/experimental/coroutine/sync_wait.hpp"
+#include "ptl/experimental/coroutine/async_generator.hpp"
+
+using namespace ptl::experimental::coroutine;
+
+TEST_CASE("async_generator")
+{
+    bool started = false;
+    auto producer = [&]() -> async_generator<int> {
+        started = true;
+        for (int i = 0; i < 5; i++) {
+            co_yield i;
+        }
+    };
+
+    auto gen = producer();
+    REQUIRE(!started);
+
+    auto sum = sync_wait([&]() -> Task<int> {
+        int sum = 0;
+        for (auto it = co_await gen.begin(); it != gen.end(); co_await ++it) {
+            sum += *it;
+        }
+        co_return sum;
+    }());
+    REQUIRE(started);
+    REQUIRE(sum == 10);
+}
+
+TEST_CASE("async_generator awaitable traits")
+{
+    using generator = async_generator<std::string>;
+    static_assert(std::is_same_v<generator::value_type, std::string>);
+    static_assert(std::is_same_v<typename awaitable_traits<decltype(std::declval<generator&>().begin())>::await_result_t,
+                                 generator::iterator>);
+    static_assert(std::is_same_v<typename awaitable_traits<decltype(++std::declval<generator::iterator&>())>::await_result_t,
+                                 generator::iterator&>);
+}
+
+TEST_CASE("async_generator empty")
+{
+    auto count = sync_wait([]() -> Task<int> {
+        auto gen = []() -> async_generator<int> { co_return; }();
+        int count = 0;
+        for (auto it = co_await gen.begin(); it != gen.end(); co_await ++it) {
+            count++;
+        }
+
+        async_generator<int> moved_from;
+        for (auto it = co_await moved_from.begin(); it != moved_from.end(); co_await ++it) {
+            count++;
+        }
+        co_return count;
+    }());
+    REQUIRE(count == 0);
+}
+
+TEST_CASE("async_generator awaits between yields")
+{
+    auto value = [](int v) -> Task<int> { co_return v * 2; };
+    auto producer = [&]() -> async_generator<const std::string> {
+        for (int i = 0; i < 3; i++) {
+            auto v = co_await value(i);
+            co_yield std::to_string(v);
+        }
+    };
+
+    auto result = sync_wait([&]() -> Task<std::vector<std::string>> {
+        std::vector<std::string> result;
+        auto gen = producer();
+        for (auto it = co_await gen.begin(); it != gen.end(); co_await ++it) {
+            result.push_back(*it);
+        }
+        co_return result;
+    }());
+    REQUIRE(result == std::vector<std::string>{"0", "2", "4"});
+}
+
+TEST_CASE("async_generator references yielded values")
+{
+    std::vector<int> values{1, 2, 3};
+    auto producer = [&]() -> async_generator<int> {
+        for (auto& v : values) {
+            co_yield v;
+        }
+    };
+
+    sync_wait([&]() -> Task<void> {
+        auto gen = producer();
+        for (auto it = co_await gen.begin(); it != gen.end(); co_await ++it) {
+            *it *= 10;
+        }
+    }());
+    REQUIRE(values == std::vector<int>{10, 20, 30});
+}
+
+TEST_CASE("async_generator with exception")
+{
+    auto producer = []() -> async_generator<int> {
+        co_yield 1;
+        throw std::logic_error("bad");
+    };
+
+    int seen = 0;
+    REQUIRE_THROWS_AS(sync_wait([&]() -> Task<void> {
+        auto gen = producer();
+        for (auto it = co_await gen.begin(); it != gen.end(); co_await ++it) {
+            seen += *it;
+        }
+    }()), std::logic_error);
+    REQUIRE(seen == 1);
+}
+
+TEST_CASE("async_generator abandoned early")
+{
+    int destroyed = 0;
+    struct counter {
+        int& count;
+        ~counter() { count++; }
+    };
+    auto producer = [&]() -> async_generator<int> {
+        counter c{destroyed};
+        for (int i = 0;; i++) {
+            co_yield i;
+        }
+    };
+
+    auto first = sync_wait([&]() -> Task<int> {
+        auto gen = producer();
+        auto it = co_await gen.begin();
+        co_return *it;
+    }());
+    REQUIRE(first == 0);
+    REQUIRE(destroyed == 1);
+}
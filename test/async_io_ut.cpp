@@ -11,6 +11,7 @@
 #include "ptl/experimental/coroutine/sync_wait.hpp"
 #include "ptl/experimental/coroutine/wait_all.hpp"
 #include "ptl/experimental/coroutine/async_scope.hpp"
+#include "ptl/experimental/coroutine/yield.hpp"
 #include "ptl/experimental/coroutine/asio/ip_endpoint.hpp"
 
 #include "ptl/mpmc_queue.hpp"
@@ -117,4 +118,80 @@ TEST_CASE("socket connection")
             co_return;
         }()
     ));
-}
\ No newline at end of file
+}
+
+TEST_CASE("inline completions yield to the loop")
+{
+    ptl::experimental::coroutine::iosvc::io_service srv;
+
+    auto [read_socket, write_socket] = socket::create_pair(srv);
+    int ticks = 0;
+    bool done = false;
+
+    sync_wait(wait_all(
+        [&, read_socket{std::move(read_socket)}]() mutable -> Task<> {
+            char buffer[1000];
+            auto res = co_await read_socket.recv(buffer, sizeof(buffer));
+            REQUIRE(res.is_value());
+        }(),
+        [&, write_socket{std::move(write_socket)}]() mutable -> Task<> {
+            co_await srv.schedule();
+            // the first sends complete inline, the socket buffer has room for them
+            for (int i = 0; i < 1000; i++) {
+                if (i == 2 * ptl::execution::cooperative_budget::initial) {
+                    REQUIRE(ticks > 0);
+                }
+                char c = 'x';
+                auto res = co_await write_socket.send(&c, 1);
+                REQUIRE(res.is_value());
+            }
+            done = true;
+        }(),
+        [&]() -> Task<> {
+            co_await srv.schedule();
+            while (!done) {
+                ++ticks;
+                co_await ptl::experimental::coroutine::yield();
+            }
+            srv.stop();
+        }(),
+        [&]() -> Task<> {
+            srv.run();
+            co_return;
+        }()));
+}
+
+TEST_CASE("socket pair stress")
+{
+    // Both ends are nearly always ready, so almost every operation completes inline: this walks
+    // millions of them through the same coroutine frames and must neither grow the stack nor
+    // reorder the stream.
+    constexpr uint64_t count = 2'000'000;
+    ptl::experimental::coroutine::iosvc::io_service srv;
+
+    auto [read_socket, write_socket] = socket::create_pair(srv);
+
+    sync_wait(wait_all(
+        [&, read_socket{std::move(read_socket)}]() mutable -> Task<> {
+            for (uint64_t i = 0; i < count; i++) {
+                uint64_t value = 0;
+                auto res = co_await read_socket.recv(&value, sizeof(value));
+                if (!res.is_value() || value != i) {
+                    FAIL("message " << i << " lost or out of order");
+                }
+            }
+            srv.stop();
+        }(),
+        [&, write_socket{std::move(write_socket)}]() mutable -> Task<> {
+            for (uint64_t i = 0; i < count; i++) {
+                auto res = co_await write_socket.send(&i, sizeof(i));
+                if (!res.is_value() || res.value() != sizeof(i)) {
+                    FAIL("send " << i << " failed");
+                }
+            }
+        }(),
+        [&]() -> Task<> {
+            srv.run();
+            co_return;
+        }()));
+}
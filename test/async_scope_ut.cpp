@@ -0,0 +1,148 @@
+#include "catch2/catch.hpp"
+#include <stdexcept>
+#include <type_traits>
+#include "ptl/experimental/coroutine/async_scope.hpp"
+#include "ptl/experimental/coroutine/event.hpp"
+#include "ptl/experimental/coroutine/sync_wait.hpp"
+#include "ptl/experimental/coroutine/task.hpp"
+#include "eager.hpp"
+
+using namespace ptl::experimental::coroutine;
+
+static Task<> wait_for(async_manual_reset_event& gate, int& done)
+{
+    co_await gate;
+    ++done;
+}
+
+TEST_CASE("async_scope joins spawned work")
+{
+    async_scope scope;
+    async_manual_reset_event gate;
+    int done = 0;
+
+    for (int i = 0; i < 10; i++) {
+        scope.spawn(wait_for(gate, done));
+    }
+    REQUIRE(scope.stats().running == 10);
+
+    gate.set();
+    sync_wait(scope.join());
+
+    auto stats = scope.stats();
+    REQUIRE(done == 10);
+    REQUIRE(stats.spawned == 10);
+    REQUIRE(stats.running == 0);
+    REQUIRE(stats.peak == 10);
+    REQUIRE(stats.failed == 0);
+}
+
+TEST_CASE("async_scope spawn starts work at once")
+{
+    async_scope scope;
+    async_manual_reset_event gate;
+    int done = 0;
+
+    // fire and forget, nothing to await
+    scope.spawn(wait_for(gate, done));
+    REQUIRE(scope.stats().running == 1);
+    gate.set();
+    REQUIRE(done == 1);
+    sync_wait(scope.join());
+}
+
+TEST_CASE("bounded_async_scope bounds the work in flight")
+{
+    bounded_async_scope scope(2);
+    async_manual_reset_event gate;
+    int done = 0;
+    bool spawner_done = false;
+
+    // the limit is part of the type: spawn() on a bounded scope has to be awaited
+    static_assert(!std::is_void_v<decltype(scope.spawn(wait_for(gate, done)))>);
+
+    [](bounded_async_scope& scope, async_manual_reset_event& gate, int& done, bool& spawner_done) -> eager {
+        for (int i = 0; i < 5; i++) {
+            co_await scope.spawn(wait_for(gate, done));
+        }
+        spawner_done = true;
+    }(scope, gate, done, spawner_done);
+
+    // the third spawn waits for a slot
+    REQUIRE(!spawner_done);
+    REQUIRE(scope.stats().spawned == 2);
+    REQUIRE(scope.stats().running == 2);
+    REQUIRE(!scope.try_spawn(wait_for(gate, done)));
+
+    gate.set();
+    REQUIRE(spawner_done);
+    sync_wait(scope.join());
+
+    auto stats = scope.stats();
+    REQUIRE(done == 5);
+    REQUIRE(stats.spawned == 5);
+    REQUIRE(stats.peak == 2);
+}
+
+TEST_CASE("async_scope collects exceptions")
+{
+    async_scope scope;
+    auto failing = []() -> Task<> {
+        throw std::runtime_error("failed");
+        co_return;
+    };
+
+    scope.spawn(failing());
+    scope.spawn([]() -> Task<> { co_return; }());
+    scope.spawn(failing());
+    sync_wait(scope.join());
+
+    REQUIRE(scope.stats().failed == 2);
+    auto exceptions = scope.take_exceptions();
+    REQUIRE(exceptions.size() == 2);
+    REQUIRE_THROWS_AS(std::rethrow_exception(exceptions[0]), std::runtime_error);
+    REQUIRE(scope.take_exceptions().empty());
+}
+
+TEST_CASE("bounded_async_scope tracks nested spawns")
+{
+    bounded_async_scope scope(5);
+    async_manual_reset_event gate;
+    int done = 0;
+
+    auto parent = [](bounded_async_scope& scope, async_manual_reset_event& gate, int& done) -> Task<> {
+        scope.try_spawn(wait_for(gate, done));
+        scope.try_spawn(wait_for(gate, done));
+        ++done;
+        co_return;
+    };
+    scope.try_spawn(parent(scope, gate, done));
+    scope.try_spawn(parent(scope, gate, done));
+
+    bool joined = false;
+    [](bounded_async_scope& scope, bool& joined) -> eager {
+        co_await scope.join();
+        joined = true;
+    }(scope, joined);
+
+    // the parents are done, their children still run
+    REQUIRE(done == 2);
+    REQUIRE(!joined);
+
+    gate.set();
+    REQUIRE(joined);
+    REQUIRE(done == 6);
+    REQUIRE(scope.stats().spawned == 6);
+}
+
+TEST_CASE("async_scope benchmark", "[.][benchmark]")
+{
+    BENCHMARK("spawn and join 1000") {
+        async_scope scope;
+        for (int i = 0; i < 1000; i++) {
+            scope.spawn([]() -> Task<> { co_return; }());
+        }
+        sync_wait(scope.join());
+        return scope.stats().spawned;
+    };
+}
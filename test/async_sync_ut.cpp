@@ -0,0 +1,223 @@
+#include "catch2/catch.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+#include "ptl/experimental/coroutine/task.hpp"
+#include "ptl/experimental/coroutine/sync_wait.hpp"
+#include "ptl/experimental/coroutine/event.hpp"
+#include "ptl/experimental/coroutine/mutex.hpp"
+#include "ptl/experimental/coroutine/semaphore.hpp"
+#include "eager.hpp"
+
+using namespace ptl::experimental::coroutine;
+
+// lowest and highest stack address resumed waiters ran at, a recursive hand over makes them far apart
+struct stack_span
+{
+    std::uintptr_t low = UINTPTR_MAX;
+    std::uintptr_t high = 0;
+
+    void mark(void* frame) noexcept
+    {
+        low = std::min(low, reinterpret_cast<std::uintptr_t>(frame));
+        high = std::max(high, reinterpret_cast<std::uintptr_t>(frame));
+    }
+};
+
+TEST_CASE("async_manual_reset_event resumes all waiters")
+{
+    async_manual_reset_event event;
+    int resumed = 0;
+
+    auto waiter = [](async_manual_reset_event& event, int& resumed) -> eager {
+        co_await event;
+        ++resumed;
+    };
+
+    waiter(event, resumed);
+    waiter(event, resumed);
+    REQUIRE(!event.is_set());
+    REQUIRE(resumed == 0);
+
+    event.set();
+    REQUIRE(event.is_set());
+    REQUIRE(resumed == 2);
+
+    waiter(event, resumed);
+    REQUIRE(resumed == 3);
+
+    event.reset();
+    waiter(event, resumed);
+    REQUIRE(resumed == 3);
+    event.set();
+    REQUIRE(resumed == 4);
+}
+
+TEST_CASE("async_manual_reset_event chained sets do not recurse")
+{
+    constexpr int waiters = 100000;
+    std::vector<async_manual_reset_event> events(waiters + 1);
+    stack_span stack;
+    int resumed = 0;
+
+    auto relay = [](async_manual_reset_event& in, async_manual_reset_event& out, stack_span& stack, int& resumed) -> eager {
+        co_await in;
+        stack.mark(__builtin_frame_address(0));
+        ++resumed;
+        out.set();
+    };
+
+    for (int i = 0; i < waiters; i++) {
+        relay(events[i], events[i + 1], stack, resumed);
+    }
+    events[0].set();
+    REQUIRE(resumed == waiters);
+    REQUIRE(events[waiters].is_set());
+    REQUIRE(stack.high - stack.low < 4096);
+}
+
+TEST_CASE("async_auto_reset_event releases one waiter per set")
+{
+    async_auto_reset_event event;
+    int resumed = 0;
+
+    auto waiter = [](async_auto_reset_event& event, int& resumed) -> eager {
+        co_await event;
+        ++resumed;
+    };
+
+    waiter(event, resumed);
+    waiter(event, resumed);
+    REQUIRE(resumed == 0);
+
+    event.set();
+    REQUIRE(resumed == 1);
+    REQUIRE(!event.is_set());
+    event.set();
+    REQUIRE(resumed == 2);
+
+    // set without waiters is kept for the next one, but only once
+    event.set();
+    event.set();
+    REQUIRE(event.is_set());
+    waiter(event, resumed);
+    REQUIRE(resumed == 3);
+    waiter(event, resumed);
+    REQUIRE(resumed == 3);
+    event.set();
+    REQUIRE(resumed == 4);
+}
+
+TEST_CASE("async_mutex hands over in FIFO order")
+{
+    async_mutex mutex;
+    std::vector<int> order;
+
+    auto locker = [](async_mutex& mutex, std::vector<int>& order, int id) -> eager {
+        co_await mutex.lock();
+        order.push_back(id);
+    };
+
+    REQUIRE(mutex.try_lock());
+    locker(mutex, order, 1);
+    locker(mutex, order, 2);
+    REQUIRE(order.empty());
+
+    mutex.unlock();
+    REQUIRE(order == std::vector<int>{ 1 });
+    REQUIRE(!mutex.try_lock());
+    mutex.unlock();
+    REQUIRE(order == std::vector<int>{ 1, 2 });
+    mutex.unlock();
+    REQUIRE(mutex.try_lock());
+    mutex.unlock();
+}
+
+TEST_CASE("async_mutex hands over a long chain without recursing")
+{
+    constexpr int waiters = 100000;
+    async_mutex mutex;
+    stack_span stack;
+    int resumed = 0;
+
+    auto locker = [](async_mutex& mutex, stack_span& stack, int& resumed) -> eager {
+        auto lock = co_await mutex.scoped_lock();
+        stack.mark(__builtin_frame_address(0));
+        ++resumed;
+    };
+
+    REQUIRE(mutex.try_lock());
+    for (int i = 0; i < waiters; i++) {
+        locker(mutex, stack, resumed);
+    }
+    mutex.unlock();
+    REQUIRE(resumed == waiters);
+    REQUIRE(stack.high - stack.low < 4096);
+    REQUIRE(mutex.try_lock());
+    mutex.unlock();
+}
+
+TEST_CASE("async_mutex scoped lock across threads")
+{
+    constexpr int threads = 4;
+    constexpr int iterations = 20000;
+    async_mutex mutex;
+    int counter = 0;
+
+    auto increment = [](async_mutex& mutex, int& counter) -> Task<> {
+        for (int i = 0; i < iterations; i++) {
+            auto lock = co_await mutex.scoped_lock();
+            ++counter;
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&]() {
+            async_wait(increment(mutex, counter));
+        });
+    }
+    for (auto& w : workers) {
+        w.join();
+    }
+    REQUIRE(counter == threads * iterations);
+    REQUIRE(mutex.try_lock());
+}
+
+TEST_CASE("async_semaphore limits concurrency")
+{
+    constexpr int threads = 4;
+    constexpr int iterations = 20000;
+    async_semaphore semaphore(2);
+    std::atomic<int> inside{ 0 };
+    std::atomic<int> peak{ 0 };
+    std::atomic<int> total{ 0 };
+
+    auto worker = [&]() -> Task<> {
+        for (int i = 0; i < iterations; i++) {
+            co_await semaphore.acquire();
+            int now = ++inside;
+            int p = peak.load();
+            while (now > p && !peak.compare_exchange_weak(p, now)) {
+            }
+            ++total;
+            --inside;
+            semaphore.release();
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&]() {
+            async_wait(worker());
+        });
+    }
+    for (auto& w : workers) {
+        w.join();
+    }
+    REQUIRE(total == threads * iterations);
+    REQUIRE(peak <= 2);
+    REQUIRE(semaphore.available() == 2);
+}
@@ -0,0 +1,319 @@
+#include "catch2/catch.hpp"
+#include "ptl/containers/bounded_ring_buffer.hpp"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+std::atomic<int> alive;
+
+// no default constructor
+struct tracked
+{
+    explicit tracked(int v)
+        : value(v)
+    {
+        alive++;
+    }
+    tracked(tracked&& other) noexcept
+        : value(other.value)
+    {
+        alive++;
+    }
+    tracked& operator=(tracked&&) noexcept = default;
+    ~tracked()
+    {
+        alive--;
+    }
+
+    int value;
+};
+
+} // namespace
+
+TEST_CASE("bounded ring buffer")
+{
+    alive = 0;
+    SECTION("push and pop")
+    {
+        ptl::bounded_ring_buffer<tracked, 4> ring;
+        REQUIRE(ring.capacity() == 4);
+        REQUIRE(!ring.pop());
+        ring.push(tracked(0));
+        for (int i = 1; i < 4; i++) {
+            REQUIRE(ring.try_emplace(i));
+        }
+        REQUIRE(!ring.try_push(tracked(4)));
+        REQUIRE(ring.count() == 4);
+        REQUIRE(alive == 4);
+        for (int i = 0; i < 4; i++) {
+            REQUIRE(ring.pop()->value == i);
+        }
+        REQUIRE(!ring.pop());
+        REQUIRE(ring.count() == 0);
+        REQUIRE(alive == 0);
+    }
+    SECTION("count across the wrap")
+    {
+        ptl::bounded_ring_buffer<int, 4> ring;
+        for (int i = 0; i < 10; i++) {
+            REQUIRE(ring.try_push(int(i)));
+            REQUIRE(ring.try_push(int(i)));
+            REQUIRE(ring.count() == 2);
+            REQUIRE(ring.pop() == i);
+            REQUIRE(ring.count() == 1);
+            REQUIRE(ring.pop() == i);
+        }
+    }
+    SECTION("exchange keeps the latest items")
+    {
+        ptl::bounded_ring_buffer<tracked, 4> ring;
+        for (int i = 0; i < 4; i++) {
+            REQUIRE(!ring.exchange(tracked(i)));
+        }
+        for (int i = 4; i < 10; i++) {
+            REQUIRE(ring.exchange(tracked(i))->value == i - 4);
+        }
+        REQUIRE(ring.count() == 4);
+        for (int i = 6; i < 10; i++) {
+            REQUIRE(ring.pop()->value == i);
+        }
+    }
+    SECTION("leftovers are destroyed with the ring")
+    {
+        {
+            ptl::bounded_ring_buffer<tracked, 4> ring;
+            ring.try_emplace(1);
+            ring.try_emplace(2);
+        }
+        REQUIRE(alive == 0);
+    }
+}
+
+TEST_CASE("bounded ring buffer with a mutex")
+{
+    constexpr int items = 100000;
+    ptl::bounded_ring_buffer<int, 16, std::mutex> ring;
+
+    std::vector<std::thread> producers;
+    for (int p = 0; p < 2; p++) {
+        producers.emplace_back([&] {
+            for (int i = 0; i < items;) {
+                if (ring.try_push(int(i))) {
+                    i++;
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    long sum = 0;
+    for (int i = 0; i < 2 * items;) {
+        if (auto v = ring.pop()) {
+            sum += *v;
+            i++;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    for (auto& t : producers) {
+        t.join();
+    }
+    REQUIRE(sum == 2L * items * (items - 1) / 2);
+}
+
+TEST_CASE("spsc ring buffer")
+{
+    alive = 0;
+    SECTION("push and pop")
+    {
+        ptl::bounded_ring_buffer<tracked, 4, ptl::spsc_lockless> ring;
+        REQUIRE(!ring.pop());
+        for (int i = 0; i < 4; i++) {
+            REQUIRE(ring.try_emplace(i));
+        }
+        REQUIRE(!ring.try_emplace(4));
+        REQUIRE(ring.count() == 4);
+        REQUIRE(alive == 4);
+        for (int i = 0; i < 4; i++) {
+            REQUIRE(ring.pop()->value == i);
+        }
+        REQUIRE(!ring.pop());
+        REQUIRE(alive == 0);
+
+        // across the wrap
+        REQUIRE(ring.try_push(tracked(5)));
+        REQUIRE(ring.pop()->value == 5);
+    }
+    SECTION("batches")
+    {
+        ptl::bounded_ring_buffer<std::unique_ptr<int>, 8, ptl::spsc_lockless> ring;
+        std::vector<std::unique_ptr<int>> in;
+        for (int i = 0; i < 10; i++) {
+            in.push_back(std::make_unique<int>(i));
+        }
+        REQUIRE(ring.push_n(in.begin(), 3) == 3);
+        REQUIRE(ring.push_n(in.begin() + 3, 7) == 5);
+        REQUIRE(ring.count() == 8);
+
+        std::vector<std::unique_ptr<int>> out;
+        REQUIRE(ring.pop_n(std::back_inserter(out), 6) == 6);
+        REQUIRE(ring.push_n(in.begin() + 8, 2) == 2);
+        REQUIRE(ring.pop_n(std::back_inserter(out), 100) == 4);
+        REQUIRE(out.size() == 10);
+        for (int i = 0; i < 10; i++) {
+            REQUIRE(*out[i] == i);
+        }
+    }
+    SECTION("leftovers are destroyed with the ring")
+    {
+        {
+            ptl::bounded_ring_buffer<tracked, 4, ptl::spsc_lockless> ring;
+            ring.try_emplace(1);
+            ring.try_emplace(2);
+            ring.pop();
+            ring.try_emplace(3);
+        }
+        REQUIRE(alive == 0);
+    }
+}
+
+TEST_CASE("spsc ring buffer between two threads")
+{
+    constexpr int items = 200000;
+    ptl::bounded_ring_buffer<std::string, 64, ptl::spsc_lockless> ring;
+
+    std::thread producer([&] {
+        for (int i = 0; i < items;) {
+            if (ring.try_emplace(std::to_string(i))) {
+                i++;
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    bool ordered = true;
+    for (int i = 0; i < items;) {
+        if (auto s = ring.pop()) {
+            ordered = ordered && *s == std::to_string(i);
+            i++;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+    REQUIRE(ordered);
+    REQUIRE(ring.count() == 0);
+}
+
+TEST_CASE("bounded ring buffer benchmark", "[.][benchmark]")
+{
+    constexpr int rounds = 100000;
+
+    auto cycle = [](auto& ring) {
+        long sum = 0;
+        for (int i = 0; i < rounds; i++) {
+            ring.try_push(int(i));
+            ring.try_push(int(i));
+            sum += *ring.pop();
+            sum += *ring.pop();
+        }
+        return sum;
+    };
+
+    BENCHMARK("null_lock, push and pop") {
+        ptl::bounded_ring_buffer<int, 64> ring;
+        return cycle(ring);
+    };
+
+    BENCHMARK("mutex, push and pop") {
+        ptl::bounded_ring_buffer<int, 64, std::mutex> ring;
+        return cycle(ring);
+    };
+
+    BENCHMARK("null_lock, overwriting") {
+        ptl::bounded_ring_buffer<int, 64> ring;
+        long sum = 0;
+        for (int i = 0; i < rounds; i++) {
+            sum += ring.exchange(int(i)).value_or(0);
+        }
+        return sum;
+    };
+}
+
+TEST_CASE("spsc ring buffer benchmark", "[.][benchmark]")
+{
+    constexpr int items = 100000;
+
+    auto transfer = [](auto& ring, auto push, auto pop) {
+        std::thread producer([&] {
+            for (int i = 0; i < items;) {
+                auto n = push(ring, i);
+                if (n == 0) {
+                    std::this_thread::yield();
+                }
+                i += n;
+            }
+        });
+        long sum = 0;
+        for (int i = 0; i < items;) {
+            auto n = pop(ring, sum);
+            if (n == 0) {
+                std::this_thread::yield();
+            }
+            i += n;
+        }
+        producer.join();
+        return sum;
+    };
+
+    BENCHMARK("spsc, one at a time") {
+        ptl::bounded_ring_buffer<int, 1024, ptl::spsc_lockless> ring;
+        return transfer(
+            ring, [](auto& r, int i) { return r.try_push(i) ? 1 : 0; },
+            [](auto& r, long& sum) {
+                auto v = r.pop();
+                sum += v.value_or(0);
+                return v ? 1 : 0;
+            });
+    };
+
+    BENCHMARK("spsc, batches of 32") {
+        ptl::bounded_ring_buffer<int, 1024, ptl::spsc_lockless> ring;
+        return transfer(
+            ring,
+            [](auto& r, int i) {
+                int batch[32];
+                for (int j = 0; j < 32; j++) {
+                    batch[j] = i + j;
+                }
+                return static_cast<int>(r.push_n(batch, std::min(32, items - i)));
+            },
+            [](auto& r, long& sum) {
+                int batch[32];
+                auto n = r.pop_n(batch, 32);
+                for (size_t j = 0; j < n; j++) {
+                    sum += batch[j];
+                }
+                return static_cast<int>(n);
+            });
+    };
+
+    BENCHMARK("mpsc, one at a time") {
+        ptl::bounded_ring_buffer<int, 1024, ptl::mpsc_lockless> ring;
+        return transfer(
+            ring, [](auto& r, int i) { return r.try_push(i) ? 1 : 0; },
+            [](auto& r, long& sum) {
+                auto v = r.pop();
+                sum += v.value_or(0);
+                return v ? 1 : 0;
+            });
+    };
+}
@@ -0,0 +1,135 @@
+#include "catch2/catch.hpp"
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "ptl/experimental/coroutine/task.hpp"
+#include "ptl/experimental/coroutine/sync_wait.hpp"
+#include "ptl/experimental/coroutine/channel.hpp"
+#include "eager.hpp"
+
+using namespace ptl::experimental::coroutine;
+
+TEST_CASE("channel try operations")
+{
+    channel<int> ch(2);
+
+    REQUIRE(!ch.try_recv());
+    REQUIRE(ch.try_send(1));
+    REQUIRE(ch.try_send(2));
+    REQUIRE(!ch.try_send(3));
+    REQUIRE(ch.try_recv() == 1);
+    REQUIRE(ch.try_recv() == 2);
+    REQUIRE(!ch.try_recv());
+}
+
+TEST_CASE("channel send suspends when full")
+{
+    channel<int> ch(2);
+    int sent = 0;
+
+    auto producer = [](channel<int>& ch, int& sent) -> eager {
+        for (int i = 0; i < 5; i++) {
+            bool ok = co_await ch.send(i);
+            REQUIRE(ok);
+            ++sent;
+        }
+    };
+
+    producer(ch, sent);
+    REQUIRE(sent == 2);
+
+    REQUIRE(ch.try_recv() == 0);
+    REQUIRE(sent == 3);
+    REQUIRE(ch.try_recv() == 1);
+    REQUIRE(ch.try_recv() == 2);
+    REQUIRE(ch.try_recv() == 3);
+    REQUIRE(ch.try_recv() == 4);
+    REQUIRE(sent == 5);
+}
+
+TEST_CASE("channel recv suspends when empty")
+{
+    channel<int> ch(4);
+    std::vector<int> received;
+
+    auto consumer = [](channel<int>& ch, std::vector<int>& received) -> eager {
+        while (auto v = co_await ch.recv()) {
+            received.push_back(*v);
+        }
+        received.push_back(-1);
+    };
+
+    consumer(ch, received);
+    REQUIRE(received.empty());
+
+    REQUIRE(ch.try_send(7));
+    REQUIRE(received == std::vector<int>{ 7 });
+
+    ch.close();
+    REQUIRE(received == std::vector<int>{ 7, -1 });
+}
+
+TEST_CASE("channel close drains and fails senders")
+{
+    channel<int> ch(2);
+    bool blocked_result = true;
+
+    auto producer = [](channel<int>& ch, bool& result) -> eager {
+        result = co_await ch.send(3);
+    };
+
+    REQUIRE(ch.try_send(1));
+    REQUIRE(ch.try_send(2));
+    producer(ch, blocked_result);
+    ch.close();
+
+    REQUIRE(!blocked_result);
+    REQUIRE(!ch.try_send(4));
+    REQUIRE(ch.try_recv() == 1);
+    REQUIRE(ch.try_recv() == 2);
+    REQUIRE(!ch.try_recv());
+    REQUIRE(!sync_wait(ch.recv()));
+}
+
+TEST_CASE("channel pipeline across threads")
+{
+    constexpr int producers = 3;
+    constexpr int consumers = 3;
+    constexpr int per_producer = 50000;
+
+    channel<long> ch(64);
+    std::atomic<long> sum{ 0 };
+    std::atomic<long> count{ 0 };
+
+    auto produce = [&](long base) -> Task<> {
+        for (long i = 0; i < per_producer; i++) {
+            co_await ch.send(base + i);
+        }
+    };
+    auto consume = [&]() -> Task<> {
+        while (auto v = co_await ch.recv()) {
+            sum += *v;
+            ++count;
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int c = 0; c < consumers; c++) {
+        threads.emplace_back([&]() { async_wait(consume()); });
+    }
+    std::vector<std::thread> sending;
+    for (int p = 0; p < producers; p++) {
+        sending.emplace_back([&, p]() { async_wait(produce(p * per_producer)); });
+    }
+    for (auto& t : sending) {
+        t.join();
+    }
+    ch.close();
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    long n = producers * per_producer;
+    REQUIRE(count == n);
+    REQUIRE(sum == n * (n - 1) / 2);
+}
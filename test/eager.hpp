@@ -0,0 +1,17 @@
+#pragma once
+#include <experimental/coroutine>
+#include <exception>
+
+// Runs a coroutine eagerly until its first suspension, the frame lives until the coroutine
+// completes.  Starts waiters inline so a test can check their state without an executor.
+struct eager
+{
+    struct promise_type
+    {
+        eager get_return_object() noexcept { return {}; }
+        std::experimental::suspend_never initial_suspend() noexcept { return {}; }
+        std::experimental::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { std::terminate(); }
+    };
+};
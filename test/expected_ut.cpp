@@ -1,6 +1,7 @@
 #include "catch2/catch.hpp"
 #include "ptl/expected.hpp"
 #include <exception>
+#include <string>
 
 using namespace ptl;
 expected<void, error_code> returns_null()
@@ -60,4 +61,253 @@ TEST_CASE("error_exception")
         REQUIRE(v.is_value() == true);
         REQUIRE(v.value() == 0);
     }
-}
\ No newline at end of file
+}
+TEST_CASE("compact storage")
+{
+    using ptr_result = expected<int*, error_code>;
+    using int_result = expected<int32_t, error_code>;
+    using void_result = expected<void, error_code>;
+    using size_result = expected<size_t, error_code>;
+
+    SECTION("layout")
+    {
+        // trivially copyable, so returned in registers, and a single one up to 32 bit values and pointers
+        STATIC_REQUIRE(std::is_trivially_copyable_v<ptr_result>);
+        STATIC_REQUIRE(std::is_trivially_copyable_v<int_result>);
+        STATIC_REQUIRE(std::is_trivially_copyable_v<void_result>);
+        STATIC_REQUIRE(std::is_trivially_copyable_v<size_result>);
+        STATIC_REQUIRE(sizeof(ptr_result) == sizeof(uintptr_t));
+        STATIC_REQUIRE(sizeof(int_result) == sizeof(uintptr_t));
+        STATIC_REQUIRE(sizeof(void_result) == sizeof(uintptr_t));
+        STATIC_REQUIRE(sizeof(size_result) == 2 * sizeof(uintptr_t));
+
+        // anything else keeps the union storage
+        STATIC_REQUIRE(!std::is_trivially_copyable_v<expected<int32_t, error_code, error_policy_assert, expected_storage_union>>);
+        STATIC_REQUIRE(!std::is_trivially_copyable_v<expected<std::string, error_code>>);
+    }
+
+    SECTION("pointers")
+    {
+        int x = 7;
+        ptr_result v = &x;
+        REQUIRE(v.is_value());
+        REQUIRE(!v.is_error());
+        REQUIRE(*v.value() == 7);
+
+        ptr_result null = nullptr;
+        REQUIRE(null.is_value());
+        REQUIRE(null.value() == nullptr);
+
+        ptr_result e = error_code{ -5 };
+        REQUIRE(e.is_error());
+        REQUIRE(!e.is_value());
+        REQUIRE(e.error().value() == -5);
+
+        REQUIRE(!ptr_result().is_value());
+        REQUIRE(!ptr_result().is_error());
+    }
+
+    SECTION("32 bit values")
+    {
+        int_result v = -1;
+        REQUIRE(v.is_value());
+        REQUIRE(v.value() == -1);
+        v.value() = 3;
+        REQUIRE(std::move(v).value() == 3);
+
+        int_result e = error_code{ -1 };
+        REQUIRE(e.is_error());
+        REQUIRE(e.error().value() == -1);
+        e = 4;
+        REQUIRE(e.value() == 4);
+    }
+
+    SECTION("void")
+    {
+        void_result ok;
+        REQUIRE(!ok.is_error());
+        ok.value();
+
+        void_result e = error_code{ -2 };
+        REQUIRE(e.is_error());
+        REQUIRE(e.error().value() == -2);
+    }
+
+    SECTION("values too big for a word")
+    {
+        size_result v = ~size_t(0);
+        REQUIRE(v.is_value());
+        REQUIRE(v.value() == ~size_t(0));
+
+        size_result e = error_code{ -9 };
+        REQUIRE(e.is_error());
+        REQUIRE(e.error().value() == -9);
+    }
+
+    SECTION("throwing policy")
+    {
+        expected<int32_t, error_code, error_policy_throw> e = error_code{ -1 };
+        REQUIRE_THROWS_AS(e.value(), std::logic_error);
+    }
+}
+
+namespace {
+
+template <typename RESULT>
+[[gnu::noinline]] RESULT checked_read(int32_t n)
+{
+    if (n < 0) {
+        return error_code{ n };
+    }
+    return n;
+}
+
+template <typename RESULT>
+int64_t sum_reads(int count)
+{
+    int64_t sum = 0;
+    for (int i = 0; i < count; i++) {
+        auto r = checked_read<RESULT>((i & 15) == 15 ? -1 : i);
+        sum += r.is_value() ? r.value() : r.error().value();
+    }
+    return sum;
+}
+
+} // namespace
+
+TEST_CASE("compact storage benchmark", "[.][benchmark]")
+{
+    constexpr int count = 1000000;
+
+    BENCHMARK("expected<int32_t, error_code>, compact") {
+        return sum_reads<expected<int32_t, error_code>>(count);
+    };
+
+    BENCHMARK("expected<int32_t, error_code>, union") {
+        return sum_reads<expected<int32_t, error_code, error_policy_assert, expected_storage_union>>(count);
+    };
+}
+
+namespace {
+
+struct move_counted
+{
+    static inline int copies = 0;
+    static inline int moves = 0;
+
+    explicit move_counted(int v)
+        : value(v)
+    {}
+    move_counted(const move_counted& other)
+        : value(other.value)
+    {
+        copies++;
+    }
+    move_counted(move_counted&& other) noexcept
+        : value(other.value)
+    {
+        moves++;
+    }
+
+    int value;
+};
+
+using counted_result = expected<move_counted, error_code>;
+
+counted_result parse(int v)
+{
+    if (v < 0) {
+        return error_code{ v };
+    }
+    return move_counted(v);
+}
+
+expected<int32_t, error_code> half(int32_t v)
+{
+    if (v % 2 != 0) {
+        return error_code{ -1 };
+    }
+    return v / 2;
+}
+
+expected<int32_t, error_code> quarter(int32_t v)
+{
+    auto h = PTL_TRY(half(v));
+    return PTL_TRY(half(h));
+}
+
+expected<void, error_code> check_all(int32_t v)
+{
+    PTL_TRY(returns_null());
+    PTL_TRY(quarter(v));
+    return {};
+}
+
+} // namespace
+
+TEST_CASE("monadic operations")
+{
+    SECTION("and_then")
+    {
+        REQUIRE(half(8).and_then(half).value() == 2);
+        REQUIRE(half(6).and_then(half).error().value() == -1);
+        REQUIRE(half(3).and_then(half).error().value() == -1);
+        REQUIRE(returns_null().and_then([] { return half(4); }).value() == 2);
+        REQUIRE(returns_null_error().and_then([] { return half(4); }).error().value() == -3);
+    }
+    SECTION("transform")
+    {
+        auto r = half(8).transform([](int32_t v) { return std::to_string(v); });
+        static_assert(std::is_same_v<decltype(r), expected<std::string, error_code>>);
+        REQUIRE(r.value() == "4");
+        REQUIRE(half(3).transform([](int32_t v) { return v + 1; }).error().value() == -1);
+
+        int seen = 0;
+        auto v = half(8).transform([&](int32_t v) { seen = v; });
+        static_assert(std::is_same_v<decltype(v), expected<void, error_code>>);
+        REQUIRE(!v.is_error());
+        REQUIRE(seen == 4);
+    }
+    SECTION("or_else")
+    {
+        auto recover = [](const error_code&) { return expected<int32_t, error_code>(0); };
+        REQUIRE(half(3).or_else(recover).value() == 0);
+        REQUIRE(half(8).or_else(recover).value() == 4);
+        REQUIRE(returns_null_error().or_else([](error_code e) { return expected<void, error_code>(e); }).is_error());
+    }
+    SECTION("transform_error")
+    {
+        auto r = half(3).transform_error([](const error_code& e) { return std::to_string(e.value()); });
+        static_assert(std::is_same_v<decltype(r), expected<int32_t, std::string>>);
+        REQUIRE(r.error() == "-1");
+        REQUIRE(returns_null().transform_error([](const error_code& e) { return e.value(); }).is_error() == false);
+    }
+    SECTION("rvalue chains move the value along")
+    {
+        move_counted::copies = 0;
+        move_counted::moves = 0;
+        auto r = parse(1)
+                     .and_then([](move_counted&& m) { m.value++; return counted_result(std::move(m)); })
+                     .transform([](move_counted&& m) { m.value *= 10; return std::move(m); })
+                     .transform_error([](error_code&& e) { return e; })
+                     .or_else([](error_code&& e) { return counted_result(std::move(e)); });
+        REQUIRE(r.value().value == 20);
+        REQUIRE(move_counted::copies == 0);
+    }
+    SECTION("lvalue chains leave the expected alone")
+    {
+        move_counted::copies = 0;
+        auto r = parse(5);
+        auto v = r.transform([](const move_counted& m) { return m.value; });
+        REQUIRE(v.value() == 5);
+        REQUIRE(move_counted::copies == 0);
+        REQUIRE(r.value().value == 5);
+    }
+    SECTION("PTL_TRY")
+    {
+        REQUIRE(quarter(8).value() == 2);
+        REQUIRE(quarter(6).error().value() == -1);
+        REQUIRE(!check_all(4).is_error());
+        REQUIRE(check_all(2).is_error());
+    }
+}
@@ -0,0 +1,391 @@
+#include "catch2/catch.hpp"
+#include "ptl/intrusive_ptr.hpp"
+
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace {
+
+std::atomic<int> destroyed;
+
+template <typename POLICY>
+struct counted : ptl::intrusive_ref_counted<counted<POLICY>, POLICY>
+{
+    explicit counted(int v)
+        : value(v)
+    {}
+
+    ~counted()
+    {
+        destroyed++;
+    }
+
+    int value;
+};
+
+using atomic_counted = counted<ptl::intrusive_refcount_atomic>;
+using biased_counted = counted<ptl::intrusive_refcount_biased>;
+
+struct weakly_counted
+{
+    ptl::intrusive_weak_references references;
+    int value = 0;
+
+    ~weakly_counted()
+    {
+        destroyed++;
+    }
+};
+
+void intrusive_ptr_add_ref(weakly_counted* ptr)
+{
+    ptl::intrusive_weak_ptr_add_ref(&ptr->references);
+}
+
+void intrusive_ptr_release(weakly_counted* ptr)
+{
+    ptl::intrusive_weak_ptr_release(&ptr->references, ptr);
+}
+
+void intrusive_wptr_add_ref(weakly_counted* ptr)
+{
+    ptl::intrusive_weak_ptr_add_weak_ref(&ptr->references);
+}
+
+void intrusive_wptr_release(weakly_counted* ptr)
+{
+    ptl::intrusive_weak_ptr_release_weak(&ptr->references);
+}
+
+bool intrusive_wptr_lock(weakly_counted* ptr)
+{
+    return ptl::intrusive_weak_ptr_lock(&ptr->references);
+}
+
+struct made : ptl::intrusive_weak_ref_counted<made>
+{
+    explicit made(int v)
+    {
+        if (v < 0) {
+            throw std::invalid_argument("negative");
+        }
+        value = v;
+    }
+
+    ~made()
+    {
+        destroyed++;
+    }
+
+    int value;
+};
+
+struct alignas(64) aligned_made : ptl::intrusive_weak_ref_counted<aligned_made>
+{
+    char data[64];
+};
+
+std::atomic<int> allocations;
+std::atomic<int> deallocations;
+
+template <typename T>
+struct counting_allocator
+{
+    using value_type = T;
+
+    counting_allocator() noexcept = default;
+    template <typename U>
+    counting_allocator(const counting_allocator<U>&) noexcept
+    {}
+
+    T* allocate(size_t n)
+    {
+        allocations++;
+        return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T* ptr, size_t n) noexcept
+    {
+        deallocations++;
+        std::allocator<T>().deallocate(ptr, n);
+    }
+
+    template <typename U>
+    bool operator==(const counting_allocator<U>&) const noexcept
+    {
+        return true;
+    }
+    template <typename U>
+    bool operator!=(const counting_allocator<U>&) const noexcept
+    {
+        return false;
+    }
+};
+
+template <typename T>
+void copy_from_threads(const ptl::intrusive_ptr<T>& ptr, int threads_count, int rounds)
+{
+    std::vector<std::thread> threads;
+    for (int t = 0; t < threads_count; t++) {
+        threads.emplace_back([&] {
+            for (int i = 0; i < rounds; i++) {
+                auto copy = ptr;
+                auto again = copy;
+                copy.reset();
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+}
+
+} // namespace
+
+TEMPLATE_TEST_CASE("intrusive ptr reference counts", "", atomic_counted, biased_counted)
+{
+    destroyed = 0;
+    ptl::intrusive_ptr<TestType> p(new TestType(42));
+    {
+        auto copy = p;
+        auto moved = std::move(copy);
+        REQUIRE(!copy);
+        REQUIRE(moved->value == 42);
+    }
+    REQUIRE(destroyed == 0);
+    p.reset();
+    REQUIRE(destroyed == 1);
+}
+
+TEMPLATE_TEST_CASE("intrusive ptr shared between threads", "", atomic_counted, biased_counted)
+{
+    destroyed = 0;
+    ptl::intrusive_ptr<TestType> p(new TestType(1));
+    auto owner_copy = p;
+    copy_from_threads(p, 4, 100000);
+    REQUIRE(destroyed == 0);
+    p.reset();
+    owner_copy.reset();
+    REQUIRE(destroyed == 1);
+}
+
+TEST_CASE("biased reference dropped away from its owner")
+{
+    destroyed = 0;
+    ptl::intrusive_ptr<biased_counted> p(new biased_counted(7));
+    auto kept = p;
+
+    // the owner's references are dropped elsewhere, the owner merges them when it next releases one
+    std::thread([q = std::move(p)]() mutable {
+        auto copy = q;
+        q.reset();
+    }).join();
+    REQUIRE(destroyed == 0);
+
+    ptl::intrusive_ptr<biased_counted> last;
+    std::thread([&] {
+        last = kept;
+    }).join();
+    kept.reset();
+    REQUIRE(destroyed == 0);
+
+    // merged, the owner's copies are shared counts now
+    auto again = last;
+    last.reset();
+    std::thread([r = std::move(again)]() mutable {
+        r.reset();
+    }).join();
+    REQUIRE(destroyed == 1);
+}
+
+TEST_CASE("biased reference outlives its owner thread")
+{
+    destroyed = 0;
+    ptl::intrusive_ptr<biased_counted> p;
+    std::thread([&] {
+        p = new biased_counted(3);
+        auto copy = p;
+    }).join();
+
+    auto copy = p;
+    p.reset();
+    REQUIRE(destroyed == 0);
+    copy.reset();
+    REQUIRE(destroyed == 1);
+}
+
+TEST_CASE("biased references collected by an idle owner")
+{
+    destroyed = 0;
+    ptl::intrusive_ptr<biased_counted> p(new biased_counted(5));
+    std::thread([q = std::move(p)]() mutable {
+        q.reset();
+    }).join();
+    REQUIRE(destroyed == 0);
+    ptl::intrusive_biased_collect();
+    REQUIRE(destroyed == 1);
+}
+
+TEST_CASE("biased references released together away from their owner")
+{
+    constexpr int rounds = 10000;
+    destroyed = 0;
+    for (int i = 0; i < rounds; i++) {
+        ptl::intrusive_ptr<biased_counted> p(new biased_counted(i));
+        ptl::intrusive_ptr<biased_counted> shared_copy;
+        std::thread([&] {
+            shared_copy = p;
+        }).join();
+
+        // one reference counted in shared, the other in the owner's local, both dropped at once
+        std::atomic<int> ready{ 0 };
+        auto release = [&ready](ptl::intrusive_ptr<biased_counted> q) {
+            ready++;
+            while (ready.load() < 2) {
+                std::this_thread::yield();
+            }
+            q.reset();
+        };
+        std::thread a(release, std::move(shared_copy));
+        std::thread b(release, std::move(p));
+        a.join();
+        b.join();
+        ptl::intrusive_biased_collect();
+        REQUIRE(destroyed == i + 1);
+    }
+}
+
+TEST_CASE("intrusive weak ptr")
+{
+    destroyed = 0;
+    SECTION("no weak references")
+    {
+        ptl::intrusive_ptr<weakly_counted> p(new weakly_counted);
+        auto copy = p;
+        p.reset();
+        REQUIRE(destroyed == 0);
+        copy.reset();
+        REQUIRE(destroyed == 1);
+    }
+    SECTION("weak references outlive the object")
+    {
+        ptl::intrusive_ptr<weakly_counted> p(new weakly_counted);
+        auto weak = p.weak();
+        {
+            auto locked = weak.lock();
+            REQUIRE(locked);
+            p.reset();
+            REQUIRE(destroyed == 0);
+        }
+        REQUIRE(destroyed == 1);
+        REQUIRE(!weak.lock());
+        weak.reset();
+    }
+    SECTION("the last weak reference goes first")
+    {
+        ptl::intrusive_ptr<weakly_counted> p(new weakly_counted);
+        p.weak().reset();
+        p.reset();
+        REQUIRE(destroyed == 1);
+    }
+}
+
+TEST_CASE("make intrusive")
+{
+    destroyed = 0;
+    allocations = 0;
+    deallocations = 0;
+
+    SECTION("objects with their own count are made with new")
+    {
+        auto p = ptl::make_intrusive<atomic_counted>(4);
+        REQUIRE(p->value == 4);
+        p.reset();
+        REQUIRE(destroyed == 1);
+    }
+    SECTION("the control block and the object share one allocation")
+    {
+        auto p = ptl::allocate_intrusive<made>(counting_allocator<made>(), 8);
+        REQUIRE(p->value == 8);
+        REQUIRE(allocations == 1);
+
+        auto weak = p.weak();
+        auto copy = weak.lock();
+        REQUIRE(copy.get() == p.get());
+        p.reset();
+        copy.reset();
+        REQUIRE(destroyed == 1);
+        REQUIRE(deallocations == 0);
+        REQUIRE(!weak.lock());
+
+        weak.reset();
+        REQUIRE(deallocations == 1);
+    }
+    SECTION("without weak references the memory goes with the object")
+    {
+        auto p = ptl::allocate_intrusive<made>(counting_allocator<made>(), 1);
+        p.reset();
+        REQUIRE(destroyed == 1);
+        REQUIRE(deallocations == 1);
+    }
+    SECTION("a throwing constructor gives the memory back")
+    {
+        REQUIRE_THROWS_AS(ptl::allocate_intrusive<made>(counting_allocator<made>(), -1), std::invalid_argument);
+        REQUIRE(allocations == 1);
+        REQUIRE(deallocations == 1);
+    }
+    SECTION("over-aligned objects")
+    {
+        auto p = ptl::make_intrusive<aligned_made>();
+        REQUIRE(reinterpret_cast<uintptr_t>(p.get()) % 64 == 0);
+        auto weak = p.weak();
+        p.reset();
+        REQUIRE(!weak.lock());
+    }
+}
+
+TEST_CASE("intrusive ptr copies benchmark", "[.][benchmark]")
+{
+    constexpr int threads_count = 4;
+    constexpr int rounds = 100000;
+
+    auto owner_copies = [&](auto make) {
+        std::vector<std::thread> threads;
+        for (int t = 0; t < threads_count; t++) {
+            threads.emplace_back([&] {
+                auto p = make();
+                for (int i = 0; i < rounds; i++) {
+                    auto copy = p;
+                    auto again = copy;
+                }
+            });
+        }
+        for (auto& t : threads) {
+            t.join();
+        }
+        return destroyed.load();
+    };
+
+    BENCHMARK("atomic, copied by their owners") {
+        return owner_copies([] { return ptl::intrusive_ptr<atomic_counted>(new atomic_counted(0)); });
+    };
+
+    BENCHMARK("biased, copied by their owners") {
+        return owner_copies([] { return ptl::intrusive_ptr<biased_counted>(new biased_counted(0)); });
+    };
+
+    BENCHMARK("atomic, copied by 4 threads") {
+        ptl::intrusive_ptr<atomic_counted> p(new atomic_counted(0));
+        copy_from_threads(p, threads_count, rounds);
+        return p->value;
+    };
+
+    BENCHMARK("biased, copied by 4 threads") {
+        ptl::intrusive_ptr<biased_counted> p(new biased_counted(0));
+        copy_from_threads(p, threads_count, rounds);
+        return p->value;
+    };
+}
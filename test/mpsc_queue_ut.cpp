@@ -0,0 +1,93 @@
+#include "catch2/catch.hpp"
+#include "ptl/containers/mpsc_queue.hpp"
+
+#include <thread>
+#include <vector>
+
+struct in_queue
+{
+    in_queue() = default;
+    in_queue(int p, int s)
+        : producer(p)
+        , sequence(s)
+    {}
+
+    int producer = 0;
+    int sequence = 0;
+
+    ptl::MPSCQueueEntry<SLIST_BINDING(in_queue, entry1)> entry1;
+    ptl::MPSCQueueEntry<SLIST_BINDING(in_queue, entry2)> entry2;
+};
+MAKE_SLIST_BINDING(in_queue, entry1);
+MAKE_SLIST_BINDING(in_queue, entry2);
+
+TEST_CASE("mpsc queue")
+{
+    ptl::MPSCQueue<SLIST_BINDING(in_queue, entry1)> queue1;
+    ptl::MPSCQueue<SLIST_BINDING(in_queue, entry2)> queue2;
+    in_queue items[3] = { {0, 1}, {0, 2}, {0, 3} };
+
+    REQUIRE(queue1.empty());
+    REQUIRE(queue1.pop() == nullptr);
+
+    for (auto& item : items) {
+        queue1.push(&item);
+    }
+    // the same item can be in both queues at once
+    queue2.push(&items[2]);
+    REQUIRE(!queue1.empty());
+
+    REQUIRE(queue1.pop() == &items[0]);
+    REQUIRE(queue1.pop() == &items[1]);
+    queue1.push(&items[0]);
+    REQUIRE(queue1.pop() == &items[2]);
+    REQUIRE(queue1.pop() == &items[0]);
+    REQUIRE(queue1.pop() == nullptr);
+    REQUIRE(queue1.empty());
+
+    REQUIRE(queue2.pop() == &items[2]);
+    REQUIRE(queue2.empty());
+}
+
+TEST_CASE("mpsc queue with concurrent producers")
+{
+    constexpr int producers = 4;
+    constexpr int per_producer = 100000;
+
+    ptl::MPSCQueue<SLIST_BINDING(in_queue, entry1)> queue;
+    std::vector<in_queue> items(producers * per_producer);
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; p++) {
+        threads.emplace_back([&, p] {
+            for (int i = 0; i < per_producer; i++) {
+                auto& item = items[p * per_producer + i];
+                item.producer = p;
+                item.sequence = i;
+                queue.push(&item);
+            }
+        });
+    }
+
+    // every producer's items come out in the order it pushed them
+    std::vector<int> next(producers, 0);
+    int received = 0;
+    bool ordered = true;
+    while (received < producers * per_producer) {
+        auto item = queue.pop();
+        if (item == nullptr) {
+            std::this_thread::yield();
+            continue;
+        }
+        ordered = ordered && item->sequence == next[item->producer];
+        next[item->producer] = item->sequence + 1;
+        received++;
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    REQUIRE(ordered);
+    REQUIRE(queue.pop() == nullptr);
+    REQUIRE(queue.empty());
+}
@@ -0,0 +1,106 @@
+#include "catch2/catch.hpp"
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "ptl/experimental/coroutine/scheduling/ordered_scheduler.hpp"
+#include "eager.hpp"
+
+using namespace ptl::experimental::coroutine;
+
+TEST_CASE("mpsc ring buffer")
+{
+    ptl::bounded_ring_buffer<int, 4, ptl::mpsc_lockless> ring;
+
+    REQUIRE(!ring.pop());
+    for (int i = 0; i < 4; i++) {
+        REQUIRE(ring.try_push(i));
+    }
+    REQUIRE(!ring.try_push(4));
+    REQUIRE(ring.count() == 4);
+    for (int i = 0; i < 4; i++) {
+        REQUIRE(ring.pop() == i);
+    }
+    REQUIRE(!ring.pop());
+    REQUIRE(ring.try_push(5));
+    REQUIRE(ring.pop() == 5);
+}
+
+TEST_CASE("ordered scheduler is round robin")
+{
+    OrderedScheduler<> scheduler;
+    std::vector<int> order;
+
+    auto worker = [](OrderedScheduler<>& scheduler, std::vector<int>& order, int id) -> eager {
+        for (int i = 0; i < 3; i++) {
+            co_await scheduler.schedule();
+            order.push_back(id);
+        }
+    };
+
+    worker(scheduler, order, 1);
+    worker(scheduler, order, 2);
+    worker(scheduler, order, 3);
+    REQUIRE(order.empty());
+
+    REQUIRE(scheduler.run_pending() == 3);
+    REQUIRE(order == std::vector<int>{ 1, 2, 3 });
+    while (scheduler.run_one()) {
+    }
+    REQUIRE(order == std::vector<int>{ 1, 2, 3, 1, 2, 3, 1, 2, 3 });
+    REQUIRE(scheduler.empty());
+}
+
+TEST_CASE("ordered scheduler yield transfers to oldest")
+{
+    OrderedScheduler<> scheduler;
+    std::vector<int> order;
+
+    auto worker = [](OrderedScheduler<>& scheduler, std::vector<int>& order, int id) -> eager {
+        co_await scheduler.schedule();
+        for (int i = 0; i < 2; i++) {
+            order.push_back(id);
+            co_await scheduler.yield();
+        }
+    };
+
+    worker(scheduler, order, 1);
+    worker(scheduler, order, 2);
+    scheduler.run_one();
+    while (scheduler.run_one()) {
+    }
+    REQUIRE(order == std::vector<int>{ 1, 2, 1, 2 });
+}
+
+TEST_CASE("ordered scheduler fed by many threads")
+{
+    constexpr int producers = 4;
+    constexpr int per_producer = 20000;
+    OrderedScheduler<64> scheduler;
+    std::atomic<int> done{ 0 };
+    std::atomic<int> busy{ 0 };
+
+    auto task = [](OrderedScheduler<64>& scheduler, std::atomic<int>& done) -> eager {
+        co_await scheduler.schedule();
+        ++done;
+    };
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; p++) {
+        threads.emplace_back([&]() {
+            for (int i = 0; i < per_producer; i++) {
+                task(scheduler, done);
+                // producers may poll while the consumer pops
+                if (!scheduler.empty()) {
+                    busy.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+        });
+    }
+    while (done != producers * per_producer) {
+        scheduler.run_one();
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    REQUIRE(scheduler.empty());
+}
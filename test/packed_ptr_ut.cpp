@@ -16,4 +16,42 @@ TEST_CASE("construction")
     exc_ptr.set_value(0xffff);
     exc_ptr.set_small(0x7);
     printf("%lx\n", exc_ptr.internal());
-}
\ No newline at end of file
+}
+TEST_CASE("atomic packed pointer compare exchange")
+{
+    int a = 0, b = 0;
+    ptl::AtomicPackedPtr<int> ptr;
+    ptr.store(&a, 7);
+
+    int* expected_ptr = &a;
+    uint16_t expected_tag = 6;
+    REQUIRE(!ptr.compare_exchange_strong(expected_ptr, expected_tag, &b, 8));
+    REQUIRE(expected_ptr == &a);
+    REQUIRE(expected_tag == 7);
+
+    REQUIRE(ptr.compare_exchange_strong(expected_ptr, expected_tag, &b, 8));
+    REQUIRE(ptr.get() == &b);
+    REQUIRE(ptr.value() == 8);
+
+    while (!ptr.compare_exchange_weak(expected_ptr = &b, expected_tag = 8, &a, 9, std::memory_order_acq_rel,
+                                      std::memory_order_acquire)) {
+    }
+    REQUIRE(ptr.load() == std::pair<int*, uint16_t>{ &a, 9 });
+}
+
+TEST_CASE("atomic packed pointer tag")
+{
+    int a = 0;
+    ptl::AtomicPackedPtr<int> ptr;
+    ptr.store(&a, 0xfffe);
+
+    REQUIRE(ptr.fetch_increment_tag() == std::pair<int*, uint16_t>{ &a, 0xfffe });
+    REQUIRE(ptr.fetch_increment_tag() == std::pair<int*, uint16_t>{ &a, 0xffff });
+    // the tag wraps without touching the pointer
+    REQUIRE(ptr.load() == std::pair<int*, uint16_t>{ &a, 0 });
+
+    ptr.set_value(42);
+    ptr.set(nullptr);
+    REQUIRE(ptr.value(std::memory_order_acquire) == 42);
+    REQUIRE(ptr.get(std::memory_order_acquire) == nullptr);
+}
@@ -53,3 +53,44 @@ TEST_CASE("launch 'false'")
     ));
     REQUIRE(rc != 0);
 }
+
+TEST_CASE("wait on many children")
+{
+    // the first io_service used to own libev's default loop, make sure a second one reaps too
+    io_service unused;
+    io_service svc;
+
+    constexpr size_t count = 64;
+    std::vector<std::unique_ptr<process::subprocess>> processes;
+    for (size_t i = 0; i < count; i++) {
+        processes.push_back(std::make_unique<process::subprocess>(svc));
+    }
+
+    size_t exited = 0;
+    auto lambda = [&]() -> Task<void> {
+        for (auto& p : processes) {
+            REQUIRE(p->launch("/bin/true", {}).is_error() == false);
+        }
+        // reverse order so most children have already exited when we get to them
+        for (auto i = processes.rbegin(); i != processes.rend(); ++i) {
+            auto rc = co_await (*i)->wait();
+            REQUIRE(rc.value() == 0);
+            exited++;
+        }
+        co_return;
+    };
+
+    sync_wait(wait_all(
+        [&]() -> Task<> {
+            SCOPE_EXIT({ svc.stop(); });
+
+            co_await lambda();
+            co_return;
+        }(),
+        [&svc]() -> Task<> {
+            svc.run();
+            co_return;
+        }()
+    ));
+    REQUIRE(exited == count);
+}
@@ -0,0 +1,188 @@
+#include "catch2/catch.hpp"
+#include "ptl/aligned_allocator.hpp"
+#include "ptl/containers/ring_buffer.hpp"
+
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <numeric>
+#include <string>
+
+TEST_CASE("ring buffer")
+{
+    SECTION("both ends")
+    {
+        ptl::ring_buffer<std::string> ring;
+        REQUIRE(ring.empty());
+        for (int i = 0; i < 20; i++) {
+            ring.push_back(std::to_string(i));
+            ring.push_front(std::to_string(-i));
+        }
+        REQUIRE(ring.size() == 40);
+        REQUIRE(ring.capacity() == 64);
+        REQUIRE(ring.front() == "-19");
+        REQUIRE(ring.back() == "19");
+
+        for (int i = 19; i >= 0; i--) {
+            REQUIRE(ring.front() == std::to_string(-i));
+            ring.pop_front();
+        }
+        for (int i = 19; i >= 0; i--) {
+            REQUIRE(ring.back() == std::to_string(i));
+            ring.pop_back();
+        }
+        REQUIRE(ring.empty());
+    }
+    SECTION("matches a deque")
+    {
+        ptl::ring_buffer<int> ring;
+        std::deque<int> deque;
+        for (int i = 0; i < 1000; i++) {
+            switch (i % 5) {
+            case 0:
+            case 1:
+                ring.push_back(i);
+                deque.push_back(i);
+                break;
+            case 2:
+                ring.push_front(i);
+                deque.push_front(i);
+                break;
+            case 3:
+                ring.pop_front();
+                deque.pop_front();
+                break;
+            case 4:
+                REQUIRE(std::equal(ring.begin(), ring.end(), deque.begin(), deque.end()));
+                break;
+            }
+        }
+        REQUIRE(ring.size() == deque.size());
+        REQUIRE(std::equal(ring.begin(), ring.end(), deque.begin(), deque.end()));
+    }
+    SECTION("growing moves the elements")
+    {
+        ptl::ring_buffer<std::unique_ptr<int>> ring;
+        for (int i = 0; i < 100; i++) {
+            ring.emplace_back(std::make_unique<int>(i));
+        }
+        for (int i = 0; i < 100; i++) {
+            REQUIRE(*ring[i] == i);
+        }
+        auto moved = std::move(ring);
+        REQUIRE(ring.empty());
+        REQUIRE(moved.size() == 100);
+    }
+    SECTION("pushing one of its own elements while full")
+    {
+        ptl::ring_buffer<std::string> ring;
+        ring.reserve(8);
+        for (int i = 0; i < 8; i++) {
+            ring.push_back(std::string(32, char('a' + i)));
+        }
+        REQUIRE(ring.size() == ring.capacity());
+        ring.push_back(ring.front());
+        REQUIRE(ring.back() == std::string(32, 'a'));
+    }
+    SECTION("contiguous spans")
+    {
+        ptl::ring_buffer<int> ring;
+        ring.reserve(8);
+        REQUIRE(ring.contiguous_spans()[0].size == 0);
+        for (int i = 0; i < 6; i++) {
+            ring.push_back(i);
+        }
+        auto spans = ring.contiguous_spans();
+        REQUIRE(spans[0].size == 6);
+        REQUIRE(spans[1].size == 0);
+
+        for (int i = 0; i < 4; i++) {
+            ring.pop_front();
+        }
+        for (int i = 6; i < 10; i++) {
+            ring.push_back(i);
+        }
+        const auto& cring = ring;
+        auto wrapped = cring.contiguous_spans();
+        REQUIRE(wrapped[0].size == 4);
+        REQUIRE(wrapped[1].size == 2);
+        REQUIRE(wrapped[0].data[0] == 4);
+        REQUIRE(wrapped[1].data[0] == 8);
+        REQUIRE(wrapped[1].data[1] == 9);
+    }
+    SECTION("aligned allocator")
+    {
+        ptl::ring_buffer<double, ptl::aligned_allocator<double, ptl::Alignment::CACHE_LINE>> ring;
+        for (int i = 0; i < 50; i++) {
+            ring.push_back(i);
+        }
+        REQUIRE(reinterpret_cast<uintptr_t>(ring.contiguous_spans()[0].data) % ptl::Alignment::CACHE_LINE == 0);
+        REQUIRE(std::accumulate(ring.begin(), ring.end(), 0.0) == 1225.0);
+    }
+}
+
+TEST_CASE("byte ring buffer")
+{
+    ptl::byte_ring_buffer<> buffer;
+    auto write = [&](const char* text) {
+        auto n = std::strlen(text);
+        auto space = buffer.prepare(n);
+        auto first = std::min(n, space[0].size);
+        std::memcpy(space[0].data, text, first);
+        std::memcpy(space[1].data, text + first, n - first);
+        buffer.commit(n);
+    };
+    auto read = [&](size_t n) {
+        std::string out;
+        for (size_t i = 0; i < n; i++) {
+            out += static_cast<char>(buffer[i]);
+        }
+        buffer.consume(n);
+        return out;
+    };
+
+    write("hello");
+    REQUIRE(buffer.capacity() == 8);
+    REQUIRE(read(3) == "hel");
+    // wraps around without growing
+    write("world");
+    REQUIRE(buffer.capacity() == 8);
+    REQUIRE(buffer.contiguous_spans()[1].size == 2);
+    REQUIRE(read(7) == "loworld");
+    REQUIRE(buffer.empty());
+
+    write("a longer message than fits");
+    REQUIRE(buffer.capacity() == 32);
+    REQUIRE(read(buffer.size()) == "a longer message than fits");
+}
+
+TEST_CASE("ring buffer benchmark", "[.][benchmark]")
+{
+    constexpr int count = 100000;
+
+    BENCHMARK("ring_buffer, queue of 64") {
+        ptl::ring_buffer<int> ring;
+        long sum = 0;
+        for (int i = 0; i < count; i++) {
+            ring.push_back(i);
+            if (ring.size() == 64) {
+                sum += ring.front();
+                ring.pop_front();
+            }
+        }
+        return sum;
+    };
+
+    BENCHMARK("std::deque, queue of 64") {
+        std::deque<int> deque;
+        long sum = 0;
+        for (int i = 0; i < count; i++) {
+            deque.push_back(i);
+            if (deque.size() == 64) {
+                sum += deque.front();
+                deque.pop_front();
+            }
+        }
+        return sum;
+    };
+}
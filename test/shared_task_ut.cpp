@@ -0,0 +1,147 @@
+#include "catch2/catch.hpp"
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "ptl/experimental/coroutine/shared_task.hpp"
+#include "ptl/experimental/coroutine/task.hpp"
+#include "ptl/experimental/coroutine/sync_wait.hpp"
+#include "ptl/experimental/coroutine/event.hpp"
+#include "eager.hpp"
+
+using namespace ptl::experimental::coroutine;
+
+TEST_CASE("shared_task starts on first await and resumes every waiter")
+{
+    async_manual_reset_event gate;
+    int runs = 0;
+
+    auto lookup = [](async_manual_reset_event& gate, int& runs) -> shared_task<std::string> {
+        ++runs;
+        co_await gate;
+        co_return "value";
+    }(gate, runs);
+
+    REQUIRE(runs == 0);
+    REQUIRE(!lookup.is_ready());
+
+    std::vector<const std::string*> seen;
+    auto waiter = [](shared_task<std::string> task, std::vector<const std::string*>& seen) -> eager {
+        const std::string& value = co_await task;
+        seen.push_back(&value);
+    };
+
+    waiter(lookup, seen);
+    waiter(lookup, seen);
+    waiter(lookup, seen);
+    REQUIRE(runs == 1);
+    REQUIRE(seen.empty());
+
+    gate.set();
+    REQUIRE(lookup.is_ready());
+    REQUIRE(seen.size() == 3);
+    REQUIRE(*seen[0] == "value");
+    REQUIRE(seen[0] == seen[1]);
+    REQUIRE(seen[1] == seen[2]);
+
+    // completed: awaiting again does not suspend and does not run the body
+    REQUIRE(sync_wait(lookup) == "value");
+    REQUIRE(runs == 1);
+}
+
+TEST_CASE("shared_task rethrows to every awaiter")
+{
+    auto failing = []() -> shared_task<int> {
+        throw std::runtime_error("failed");
+        co_return 0;
+    }();
+
+    REQUIRE_THROWS_AS(sync_wait(failing), std::runtime_error);
+    REQUIRE_THROWS_AS(sync_wait(failing), std::runtime_error);
+}
+
+TEST_CASE("shared_task<void>")
+{
+    int runs = 0;
+    shared_task<> task = [](int& runs) -> shared_task<> {
+        ++runs;
+        co_return;
+    }(runs);
+
+    sync_wait(task);
+    sync_wait([](shared_task<> task) -> Task<> {
+        co_await task;
+    }(task));
+    REQUIRE(runs == 1);
+}
+
+TEST_CASE("shared_task frame lives until the last copy is gone")
+{
+    // parameters are copied into the frame and destroyed with it
+    struct tracker
+    {
+        bool* destroyed_;
+        explicit tracker(bool& destroyed) : destroyed_(&destroyed) {}
+        tracker(tracker&& other) noexcept : destroyed_(std::exchange(other.destroyed_, nullptr)) {}
+        ~tracker() { if (destroyed_) *destroyed_ = true; }
+    };
+    bool destroyed = false;
+
+    auto task = [](tracker) -> shared_task<int> {
+        co_return 1;
+    }(tracker{destroyed});
+    REQUIRE(sync_wait(task) == 1);
+
+    {
+        auto copy = task;
+        task = shared_task<int>{};
+        REQUIRE(!destroyed);
+        REQUIRE(copy.is_ready());
+    }
+    REQUIRE(destroyed);
+
+    // never awaited, the frame is destroyed with the last copy too
+    bool unused_destroyed = false;
+    {
+        auto unused = [](tracker) -> shared_task<int> { co_return 2; }(tracker{unused_destroyed});
+        REQUIRE(!unused_destroyed);
+    }
+    REQUIRE(unused_destroyed);
+}
+
+TEST_CASE("shared_task deduplicates concurrent awaiters")
+{
+    constexpr int threads_count = 8;
+    std::atomic<int> runs{0};
+    std::atomic<int> started{0};
+    async_manual_reset_event gate;
+
+    auto lookup = [](std::atomic<int>& runs, async_manual_reset_event& gate) -> shared_task<int> {
+        runs.fetch_add(1);
+        co_await gate;
+        co_return 42;
+    }(runs, gate);
+
+    std::vector<std::thread> threads;
+    std::vector<int> results(threads_count);
+    for (int i = 0; i < threads_count; i++) {
+        threads.emplace_back([&, i] {
+            started.fetch_add(1);
+            results[i] = sync_wait(lookup);
+        });
+    }
+    while (started.load() != threads_count) {
+        std::this_thread::yield();
+    }
+    gate.set();
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    REQUIRE(runs.load() == 1);
+    for (auto r : results) {
+        REQUIRE(r == 42);
+    }
+}
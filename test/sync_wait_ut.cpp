@@ -0,0 +1,121 @@
+#include "catch2/catch.hpp"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <stdexcept>
+#include <thread>
+#include "ptl/experimental/coroutine/task.hpp"
+#include "ptl/experimental/coroutine/sync_wait.hpp"
+
+using namespace ptl::experimental::coroutine;
+
+static std::atomic<size_t> allocations{0};
+
+void* operator new(size_t sz)
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(sz)) {
+        return p;
+    }
+    throw std::bad_alloc{};
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept
+{
+    std::free(ptr);
+}
+
+struct ready_awaiter
+{
+    int value_;
+
+    bool await_ready() const noexcept { return true; }
+    void await_suspend(std::experimental::coroutine_handle<>) noexcept {}
+    int await_resume() const noexcept { return value_; }
+};
+
+// completes within await_suspend, without resuming the waiter
+struct inline_awaiter
+{
+    bool await_ready() const noexcept { return false; }
+    bool await_suspend(std::experimental::coroutine_handle<>) noexcept { return false; }
+    int await_resume() const { throw std::runtime_error("inline"); }
+};
+
+// resumed by another thread, which waits for the handle to be published
+struct remote_awaiter
+{
+    std::atomic<void*>& slot_;
+    int value_ = 0;
+
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::experimental::coroutine_handle<> coroutine) noexcept
+    {
+        value_ = 7;
+        slot_.store(coroutine.address(), std::memory_order_release);
+    }
+    int await_resume() const noexcept { return value_; }
+};
+
+TEST_CASE("sync_wait on a ready awaiter does not allocate")
+{
+    auto before = allocations.load();
+    int value = sync_wait(ready_awaiter{42});
+    auto after = allocations.load();
+
+    REQUIRE(value == 42);
+    REQUIRE(after == before);
+}
+
+TEST_CASE("sync_wait surfaces exceptions from await_resume")
+{
+    REQUIRE_THROWS_AS(sync_wait(inline_awaiter{}), std::runtime_error);
+    REQUIRE_THROWS_AS(sync_wait([]() -> Task<int> {
+        throw std::logic_error("task");
+        co_return 0;
+    }()), std::logic_error);
+}
+
+TEST_CASE("async_wait blocks until another thread resumes")
+{
+    std::atomic<void*> slot{nullptr};
+    std::thread resumer([&slot] {
+        void* address;
+        while ((address = slot.load(std::memory_order_acquire)) == nullptr) {
+            std::this_thread::yield();
+        }
+        std::experimental::coroutine_handle<>::from_address(address).resume();
+    });
+
+    auto before = allocations.load();
+    int value = async_wait(remote_awaiter{slot});
+    auto after = allocations.load();
+    resumer.join();
+
+    REQUIRE(value == 7);
+    REQUIRE(after == before);
+}
+
+TEST_CASE("sync_wait on a task")
+{
+    auto value = sync_wait([]() -> Task<int> { co_return 5; }());
+    REQUIRE(value == 5);
+
+    std::string s = sync_wait([]() -> Task<std::string> { co_return "ok"; }());
+    REQUIRE(s == "ok");
+}
+
+TEST_CASE("sync_wait benchmark", "[.][benchmark]")
+{
+    BENCHMARK("ready awaiter") {
+        return sync_wait(ready_awaiter{1});
+    };
+    BENCHMARK("inline task") {
+        return sync_wait([]() -> Task<int> { co_return 1; }());
+    };
+}
@@ -5,6 +5,8 @@
 #include "ptl/experimental/coroutine/simple_task.hpp"
 #include "ptl/experimental/coroutine/sync_wait.hpp"
 #include "ptl/experimental/coroutine/scheduling/thread_pool.hpp"
+#include "ptl/experimental/coroutine/wait_all.hpp"
+#include "ptl/experimental/coroutine/yield.hpp"
 
 using namespace ptl::experimental::coroutine;
 
@@ -166,6 +168,76 @@ TEST_CASE("task multithread")
     first.join();
     second.join();
 }
+
+static
+Task<int> hop_to(ptl::execution::Executor* ex, int value)
+{
+    co_await ptl::experimental::coroutine::detail::SchedulerAwaitable { ex };
+    REQUIRE(ptl::execution::Executor::current == ex);
+    co_return value;
+}
+
+static
+Task<int> awaits_across_executors(ptl::execution::Executor* ex1, ptl::execution::Executor* ex2)
+{
+    int sum = 0;
+    for (int i = 0; i < 1000; i++) {
+        // completes on ex2, the continuation must be posted back to ex1
+        sum += co_await hop_to(ex2, i);
+        REQUIRE(ptl::execution::Executor::current == ex1);
+    }
+    co_return sum;
+}
+
+TEST_CASE("task continuation resumes on awaiting executor")
+{
+    ptl::execution::QueuedExecutor* ex1;
+    ptl::execution::QueuedExecutor* ex2;
+    ptl::sync::manual_reset_event ev1;
+    ptl::sync::manual_reset_event ev2;
+
+    std::thread first(thread_executor, &ex1, &ev1);
+    std::thread second(thread_executor, &ex2, &ev2);
+    ev1.wait(); ev2.wait();
+
+    auto r = async_wait(awaits_across_executors(ex1, ex2).schedule_on(ex1));
+    REQUIRE(r == 999 * 1000 / 2);
+
+    ex1->stop();
+    ex2->stop();
+
+    first.join();
+    second.join();
+}
+
+TEST_CASE("yield interleaves tasks on one executor")
+{
+    ptl::execution::QueuedExecutor* ex;
+    ptl::sync::manual_reset_event ev;
+    std::thread worker(thread_executor, &ex, &ev);
+    ev.wait();
+
+    std::vector<int> order;
+    auto step = [](std::vector<int>& order, int id) -> Task<> {
+        for (int i = 0; i < 3; i++) {
+            order.push_back(id);
+            co_await yield();
+        }
+    };
+
+    // both tasks start from the executor thread, so neither can run ahead before the other is queued
+    async_wait([&]() -> Task<> {
+        co_await ptl::experimental::coroutine::detail::SchedulerAwaitable { ex };
+        std::vector<Task<>> tasks;
+        tasks.push_back(step(order, 1));
+        tasks.push_back(step(order, 2));
+        co_await wait_all(std::move(tasks));
+    }());
+    REQUIRE(order == std::vector<int>{ 1, 2, 1, 2, 1, 2 });
+
+    ex->stop();
+    worker.join();
+}
 #endif
 
 #if 0
@@ -208,4 +280,4 @@ TEST_CASE("task multithread")
     second.join();
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,124 @@
+#include "catch2/catch.hpp"
+#include "ptl/containers/treiber_stack.hpp"
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct in_stack
+{
+    int data;
+    std::atomic<bool> owned;
+
+    ptl::TreiberStackEntry<SLIST_BINDING(in_stack, entry)> entry;
+};
+MAKE_SLIST_BINDING(in_stack, entry);
+
+using stack_type = ptl::TreiberStack<SLIST_BINDING(in_stack, entry)>;
+
+TEST_CASE("treiber stack")
+{
+    stack_type stack;
+    std::vector<in_stack> items(3);
+
+    REQUIRE(stack.empty());
+    REQUIRE(stack.pop() == nullptr);
+
+    for (auto& item : items) {
+        stack.push(&item);
+    }
+    REQUIRE(!stack.empty());
+    REQUIRE(stack.pop() == &items[2]);
+    REQUIRE(stack.pop() == &items[1]);
+    stack.push(&items[2]);
+
+    auto all = stack.pop_all();
+    REQUIRE(stack.empty());
+    REQUIRE(all == &items[2]);
+    REQUIRE(stack_type::next(all) == &items[0]);
+    REQUIRE(stack_type::next(&items[0]) == nullptr);
+}
+
+// Threads take blocks from a shared free-list and give them back: no block may be handed to two
+// threads at once and none may be lost.
+template <typename POP, typename PUSH>
+static bool recycle(int threads_count, int rounds, POP pop, PUSH push)
+{
+    std::atomic<bool> exclusive{true};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < threads_count; t++) {
+        threads.emplace_back([&] {
+            for (int i = 0; i < rounds; i++) {
+                auto item = pop();
+                if (item == nullptr) {
+                    continue;
+                }
+                if (item->owned.exchange(true, std::memory_order_relaxed)) {
+                    exclusive = false;
+                }
+                item->data++;
+                item->owned.store(false, std::memory_order_relaxed);
+                push(item);
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    return exclusive;
+}
+
+TEST_CASE("treiber stack as a concurrent free-list")
+{
+    stack_type stack;
+    std::vector<in_stack> items(64);
+    for (auto& item : items) {
+        stack.push(&item);
+    }
+
+    REQUIRE(recycle(4, 100000, [&] { return stack.pop(); }, [&](in_stack* item) { stack.push(item); }));
+
+    int count = 0;
+    for (auto item = stack.pop_all(); item; item = stack_type::next(item)) {
+        count++;
+    }
+    REQUIRE(count == 64);
+}
+
+TEST_CASE("treiber stack benchmark", "[.][benchmark]")
+{
+    constexpr int threads_count = 4;
+    constexpr int rounds = 100000;
+    std::vector<in_stack> items(threads_count * 2);
+
+    BENCHMARK("treiber free-list, 4 threads") {
+        stack_type stack;
+        for (auto& item : items) {
+            stack.push(&item);
+        }
+        return recycle(threads_count, rounds, [&] { return stack.pop(); }, [&](in_stack* item) { stack.push(item); });
+    };
+
+    BENCHMARK("mutex free-list, 4 threads") {
+        std::mutex lock;
+        std::vector<in_stack*> stack;
+        for (auto& item : items) {
+            stack.push_back(&item);
+        }
+        return recycle(threads_count, rounds,
+            [&]() -> in_stack* {
+                std::scoped_lock sl(lock);
+                if (stack.empty()) {
+                    return nullptr;
+                }
+                auto item = stack.back();
+                stack.pop_back();
+                return item;
+            },
+            [&](in_stack* item) {
+                std::scoped_lock sl(lock);
+                stack.push_back(item);
+            });
+    };
+}
@@ -0,0 +1,132 @@
+#include "catch2/catch.hpp"
+#include <thread>
+#include <vector>
+#include "ptl/execution/basic_executor.hpp"
+#include "ptl/experimental/coroutine/task.hpp"
+#include "ptl/experimental/coroutine/sync_wait.hpp"
+#include "ptl/experimental/coroutine/wait_all.hpp"
+
+using namespace ptl::experimental::coroutine;
+
+static
+void thread_executor(ptl::execution::QueuedExecutor** ex, ptl::sync::manual_reset_event* ev)
+{
+    ptl::execution::QueuedExecutor executor;
+    *ex = &executor;
+    ev->set();
+    executor.run();
+}
+
+static
+Task<int> square(int value)
+{
+    co_return value * value;
+}
+
+static
+std::vector<Task<int>> make_squares(int count)
+{
+    std::vector<Task<int>> tasks;
+    tasks.reserve(count);
+    for (int i = 0; i < count; i++) {
+        tasks.push_back(square(i));
+    }
+    return tasks;
+}
+
+TEST_CASE("wait_all range of no tasks")
+{
+    auto results = sync_wait(wait_all(std::vector<Task<int>>{}));
+    REQUIRE(results.empty());
+}
+
+TEST_CASE("wait_all range keeps input order")
+{
+    auto results = sync_wait(wait_all(make_squares(100)));
+
+    REQUIRE(results.size() == 100);
+    for (int i = 0; i < 100; i++) {
+        REQUIRE(results[i] == i * i);
+    }
+}
+
+TEST_CASE("wait_all range of void tasks")
+{
+    int counter = 0;
+    auto increment = [](int& counter) -> Task<> {
+        ++counter;
+        co_return;
+    };
+
+    std::vector<Task<>> tasks;
+    for (int i = 0; i < 10; i++) {
+        tasks.push_back(increment(counter));
+    }
+    sync_wait(wait_all(std::move(tasks)));
+    REQUIRE(counter == 10);
+}
+
+TEST_CASE("wait_all range rethrows")
+{
+    auto maybe_throw = [](int i) -> Task<int> {
+        if (i == 3) {
+            throw std::runtime_error("three");
+        }
+        co_return i;
+    };
+
+    std::vector<Task<int>> tasks;
+    for (int i = 0; i < 5; i++) {
+        tasks.push_back(maybe_throw(i));
+    }
+    REQUIRE_THROWS_AS(sync_wait(wait_all(std::move(tasks))), std::runtime_error);
+}
+
+TEST_CASE("wait_all range on executor")
+{
+    ptl::execution::QueuedExecutor* ex;
+    ptl::sync::manual_reset_event ev;
+    std::thread worker(thread_executor, &ex, &ev);
+    ev.wait();
+
+    auto on_executor = [](ptl::execution::Executor* ex) -> Task<bool> {
+        co_return ptl::execution::Executor::current == ex;
+    };
+
+    std::vector<Task<bool>> tasks;
+    for (int i = 0; i < 1000; i++) {
+        tasks.push_back(on_executor(ex));
+    }
+    auto results = async_wait(wait_all(std::move(tasks), ex));
+
+    REQUIRE(results.size() == 1000);
+    for (bool r : results) {
+        REQUIRE(r);
+    }
+
+    ex->stop();
+    worker.join();
+}
+
+TEST_CASE("wait_all range fan-out", "[.][benchmark]")
+{
+    constexpr int fan_out = 10000;
+
+    BENCHMARK("inline 10k")
+    {
+        return sync_wait(wait_all(make_squares(fan_out))).size();
+    };
+
+    ptl::execution::QueuedExecutor* ex;
+    ptl::sync::manual_reset_event ev;
+    std::thread worker(thread_executor, &ex, &ev);
+    ev.wait();
+
+    BENCHMARK("executor 10k")
+    {
+        return async_wait(wait_all(make_squares(fan_out), ex)).size();
+    };
+
+    ex->stop();
+    worker.join();
+}
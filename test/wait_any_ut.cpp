@@ -0,0 +1,169 @@
+#include "catch2/catch.hpp"
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "ptl/execution/basic_executor.hpp"
+#include "ptl/experimental/coroutine/task.hpp"
+#include "ptl/experimental/coroutine/sync_wait.hpp"
+#include "ptl/experimental/coroutine/wait_any.hpp"
+
+using namespace ptl::experimental::coroutine;
+using ptl::experimental::coroutine::asio::cancellation_source;
+using ptl::experimental::coroutine::asio::cancellation_token;
+
+static
+void thread_executor(ptl::execution::QueuedExecutor** ex, ptl::sync::manual_reset_event* ev)
+{
+    ptl::execution::QueuedExecutor executor;
+    *ex = &executor;
+    ev->set();
+    executor.run();
+}
+
+// always goes through the executor queue, even when already running on it
+struct reschedule
+{
+    bool await_ready() const noexcept
+    {
+        return false;
+    }
+    void await_suspend(std::experimental::coroutine_handle<> coroutine) noexcept
+    {
+        item_.coroutine_ = coroutine;
+        executor_->post(item_);
+    }
+    void await_resume() noexcept
+    {}
+
+    ptl::execution::Executor* executor_;
+    detail::resume_work_item item_;
+};
+
+TEST_CASE("wait_any first completion wins")
+{
+    bool started = false;
+    auto value = [](int v) -> Task<int> {
+        co_return v;
+    };
+    auto never = [](bool& started) -> Task<long> {
+        started = true;
+        co_return 0;
+    };
+
+    auto [index, result] = sync_wait(wait_any(value(7), never(started)));
+    REQUIRE(index == 0);
+    REQUIRE(result == 7);
+    REQUIRE(!started);
+}
+
+TEST_CASE("wait_any void yields index")
+{
+    auto nothing = []() -> Task<> {
+        co_return;
+    };
+    REQUIRE(sync_wait(wait_any(nothing(), nothing())) == 0);
+}
+
+TEST_CASE("wait_any rethrows winner exception")
+{
+    auto fail = []() -> Task<int> {
+        throw std::runtime_error("fail");
+        co_return 0;
+    };
+    auto value = []() -> Task<int> {
+        co_return 1;
+    };
+    REQUIRE_THROWS_AS(sync_wait(wait_any(fail(), value())), std::runtime_error);
+}
+
+TEST_CASE("wait_any rejects an empty range")
+{
+    REQUIRE_THROWS_AS(wait_any(std::vector<Task<int>>{}), std::invalid_argument);
+}
+
+TEST_CASE("wait_any not awaited")
+{
+    bool started = false;
+    auto never = [](bool& started) -> Task<int> {
+        started = true;
+        co_return 0;
+    };
+    {
+        auto race = wait_any(never(started), never(started));
+    }
+    REQUIRE(!started);
+}
+
+TEST_CASE("wait_any cancels losers")
+{
+    ptl::execution::QueuedExecutor* ex;
+    ptl::sync::manual_reset_event ev;
+    std::thread worker(thread_executor, &ex, &ev);
+    ev.wait();
+
+    std::atomic<int> losers{ 0 };
+    auto loser = [](ptl::execution::Executor* ex, cancellation_token token, std::atomic<int>& losers) -> Task<int> {
+        co_await reschedule{ ex };
+        while (!token.is_cancellation_requested()) {
+            co_await reschedule{ ex };
+        }
+        losers++;
+        co_return -1;
+    };
+    auto winner = [](ptl::execution::Executor* ex) -> Task<int> {
+        co_await reschedule{ ex };
+        co_return 42;
+    };
+
+    cancellation_source source;
+    std::vector<Task<int>> tasks;
+    for (int i = 0; i < 3; i++) {
+        tasks.push_back(loser(ex, source.token(), losers));
+    }
+    tasks.push_back(winner(ex));
+
+    auto [index, result] = async_wait(wait_any(std::move(tasks), source));
+    REQUIRE(index == 3);
+    REQUIRE(result == 42);
+    REQUIRE(source.is_cancellation_requested());
+    REQUIRE(losers == 3);
+
+    ex->stop();
+    worker.join();
+}
+
+TEST_CASE("wait_any resumes after the losers completed")
+{
+    ptl::execution::QueuedExecutor* ex;
+    ptl::sync::manual_reset_event ev;
+    std::thread worker(thread_executor, &ex, &ev);
+    ev.wait();
+
+    // the loser keeps writing to the caller's frame after the race is decided
+    auto loser = [](ptl::execution::Executor* ex, cancellation_token token, int& written) -> Task<int> {
+        do {
+            co_await reschedule{ ex };
+        } while (!token.is_cancellation_requested());
+        for (int i = 0; i < 100; i++) {
+            co_await reschedule{ ex };
+            written++;
+        }
+        co_return -1;
+    };
+    auto winner = []() -> Task<int> {
+        co_return 1;
+    };
+    auto race = [](ptl::execution::Executor* ex, decltype(loser)& loser, decltype(winner)& winner) -> Task<int> {
+        cancellation_source source;
+        int written = 0;
+        auto [index, result] = co_await wait_any(source, loser(ex, source.token(), written), winner());
+        REQUIRE(index == 1);
+        REQUIRE(written == 100);
+        co_return result;
+    };
+
+    REQUIRE(async_wait(race(ex, loser, winner)) == 1);
+    ex->stop();
+    worker.join();
+}